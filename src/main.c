@@ -11,12 +11,20 @@
     *   memory.h
     *   stdio.h
     *   stdint.h
+    *   string.h
+    *   stdlib.h
+    *   time.h
+    *   threads.h   (C11 threads, or pthread.h where there isn't one, like macOS)
+    *   signal.h
+    *   termios.h, poll.h, unistd.h on Linux/macOS, and conio.h, io.h on Windows (For reading keys)
+    *   sys/ioctl.h on Linux/macOS, and windows.h on Windows (For the size of the terminal)
+    *   sys/mman.h, sys/stat.h, fcntl.h on Linux/macOS, and windows.h on Windows (For memory mapping the opening book)
     
     Which are all standard libraries, no external dependencies.
 
     Key points within this file:
     *   The main function               (Ctrl+F to find "int main(int argc, char* argv[])")
-    *   The bot function for simulation (CTRL+F to find "void run_bot(board_t* b)")
+    *   The bot function for simulation (CTRL+F to find "uPoint8 run_bot(board_t* b)")
 
     This uses ansi_console.h, which is defined below.
 
@@ -63,6 +71,92 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <signal.h>
+#if !defined(THREADS_PTHREAD) && (defined(__STDC_NO_THREADS__) || defined(__APPLE__))
+#define THREADS_PTHREAD     // No threads.h (macOS doesn't ship it), so the bits of it used are wrapped around pthreads below
+#endif
+#ifdef THREADS_PTHREAD
+#include <pthread.h>
+#else
+#include <threads.h>
+#endif
+#ifdef _WIN32
+#include <io.h>     // _setmode, for reading binary from stdin
+#include <fcntl.h>
+#include <conio.h>  // _getch, for reading keys straight away
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h> // GetConsoleScreenBufferInfo and WaitForSingleObject, for the terminal
+#else
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <poll.h>
+#endif
+
+#ifdef THREADS_PTHREAD
+/*
+    Just enough of C11 threads (threads.h) for this file, on top of pthreads.
+    Only what's used here is wrapped, and every call returns 0 (`thrd_success`) when it works.
+*/
+
+typedef pthread_t thrd_t;
+typedef pthread_mutex_t mtx_t;
+typedef pthread_once_t once_flag;
+typedef pthread_key_t tss_t;
+typedef int (*thrd_start_t)(void*);
+typedef void (*tss_dtor_t)(void*);
+
+#define ONCE_FLAG_INIT PTHREAD_ONCE_INIT
+
+enum { thrd_success = 0, thrd_error = 1 };
+enum { mtx_plain = 0 };
+
+struct thrd_start {
+    thrd_start_t func;
+    void* arg;
+};
+
+/// @brief Runs a C11 style thread function from a pthread
+static void* thrd_trampoline(void* arg) {
+    struct thrd_start start = *(struct thrd_start*)arg;
+    free(arg);
+    return (void*)(intptr_t)start.func(start.arg);
+}
+
+static int thrd_create(thrd_t* t, thrd_start_t func, void* arg) {
+    struct thrd_start* start = malloc(sizeof(struct thrd_start));
+    if(start == NULL) return thrd_error;
+    start->func = func;
+    start->arg = arg;
+    if(pthread_create(t, NULL, thrd_trampoline, start) != 0) {
+        free(start);
+        return thrd_error;
+    }
+    return thrd_success;
+}
+
+static int thrd_join(thrd_t t, int* result) {
+    void* r;
+    if(pthread_join(t, &r) != 0) return thrd_error;
+    if(result != NULL) *result = (int)(intptr_t)r;
+    return thrd_success;
+}
+
+static int mtx_init(mtx_t* m, int type) { (void)type; return pthread_mutex_init(m, NULL) == 0 ? thrd_success : thrd_error; }
+static int mtx_lock(mtx_t* m) { return pthread_mutex_lock(m) == 0 ? thrd_success : thrd_error; }
+static int mtx_unlock(mtx_t* m) { return pthread_mutex_unlock(m) == 0 ? thrd_success : thrd_error; }
+static void mtx_destroy(mtx_t* m) { pthread_mutex_destroy(m); }
+static void call_once(once_flag* flag, void (*func)(void)) { pthread_once(flag, func); }
+static int tss_create(tss_t* key, tss_dtor_t dtor) { return pthread_key_create(key, dtor) == 0 ? thrd_success : thrd_error; }
+static int tss_set(tss_t key, void* value) { return pthread_setspecific(key, value) == 0 ? thrd_success : thrd_error; }
+#endif
 
 #ifndef CONSOLE_H
 
@@ -314,10 +408,26 @@ typedef enum err err_t;
 typedef enum bool bool;
 typedef enum winner winner_t;
 
+enum bool {
+    true,
+    false
+};
+
 static bool cuP8(uPoint8 p) { return p.x <= 2 && p.y <= 2; }
 
-void run_bot(board_t* b);
+uPoint8 run_bot(board_t* b);
 uPoint8 bot_suggest(board_t* b);
+void prnt_suggestion(uPoint8 p);
+int tss_main(const char* position);
+int perft_main(int argc, char* argv[]);
+int batch_main(int argc, char* argv[]);
+int nt_train_main(int argc, char* argv[]);
+err_t nt_load(const char* path);
+int pn_main(const char* position);
+int gravity_main();
+int gravity_solve_main(const char* moves);
+err_t book_open(const char* path);
+int book_build_main(int argc, char* argv[]);
 
 /*
     Below is the actual game, and the main functionality.
@@ -368,6 +478,8 @@ board_t new_board() {
 }
 
 static board_t game_board;
+static uPoint8 select_cursor = { 5, 5 };    // The place the cursor is on while picking (Hidden if it's invalid)
+static uPoint8 last_move = { 5, 5 };        // The last place played, kept in view when the cursor is hidden
 enum plr {
     PLR_BLANK,
     PLR_X,
@@ -378,12 +490,8 @@ static plr_t active_player;
 enum err {
     ERR_SUCCESS,
     ERR_INVALID_PLACE,
-    ERR_PLACE_TAKEN
-};
-
-enum bool {
-    true,
-    false
+    ERR_PLACE_TAKEN,
+    ERR_IO          // A file couldn't be read or written, or memory couldn't be allocated
 };
 
 enum winner {
@@ -393,152 +501,495 @@ enum winner {
     WINNER_TIE
 };
 
-/// @brief Prints the board to the screen
-/// @param b The board
-void prnt_board(board_t b) {
-    // It does a line 6 times
+/*
+    Tracing
+
+    Turned on with `--trace <file>`, this records how long each part of the bot takes
+    (The checks, each move it simulates, drawing the board) so a slow move can be
+    looked at afterwards without needing a profiler.
+
+    Each thread writes its spans into its own ring buffer, with no locking, and the
+    buffer only gets written out to the file (Under a lock) when it fills up, when the
+    thread exits, or when the program exits. When a thread exits its ring is handed on
+    to the next thread that starts, so the batch and suggestion threads that come and go
+    don't run out of them. When tracing is off, starting and ending a span is just a check.
+
+    The file is written as:
+    *   Chrome trace JSON       (Open it in chrome://tracing or https://ui.perfetto.dev)
+    *   Folded stacks           (If the file ends in ".folded", for flamegraph.pl or speedscope)
+*/
+
+#define TRACE_RING_SIZE     1024    // Spans each thread holds before writing them out
+#define TRACE_MAX_DEPTH     8       // Spans nested deeper than this aren't recorded
+#define TRACE_MAX_THREADS   64      // Threads traced at the same time, spans from any more are dropped
+
+typedef struct trace_span trace_span_t;
+typedef struct trace_ring trace_ring_t;
+
+struct trace_span {
+    const char* stack[TRACE_MAX_DEPTH]; // The names of this span and the spans it's inside of
+    uint8_t depth;
+    uint64_t start;                     // Nanoseconds
+    uint64_t duration;
+    uint64_t self;                      // Time not spent in the spans inside of it
+};
+
+struct trace_ring {
+    uint32_t thread;
+    trace_span_t spans[TRACE_RING_SIZE];
+    uint32_t count;
+
+    // The spans that have been started but not ended yet
+    const char* open_names[TRACE_MAX_DEPTH];
+    uint64_t open_start[TRACE_MAX_DEPTH];
+    uint64_t open_children[TRACE_MAX_DEPTH];
+    uint8_t open_depth;
+    uint8_t overflow;                   // How far past `TRACE_MAX_DEPTH` it's nested
+    uint8_t in_use;                     // A thread that's still running has it
+};
+
+static FILE* trace_file = NULL;
+static uint8_t trace_folded = 0;
+static uint8_t trace_first = 1;         // No comma before the first JSON event
+static uint64_t trace_epoch = 0;
+static mtx_t trace_lock;
+static trace_ring_t* trace_rings[TRACE_MAX_THREADS];
+static uint32_t trace_ring_count = 0;
+static uint32_t trace_dropped = 0;      // Threads that couldn't get a ring
+static tss_t trace_ring_key;            // Hands the ring back when its thread exits
+static _Thread_local trace_ring_t* trace_ring = NULL;
+
+/// @brief Gets the time
+/// @return The time in nanoseconds
+static uint64_t trace_now() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/// @brief Works out how long it's been since a time from `trace_now`, for the tools that print how long they took
+/// @param start The time it started (Nanoseconds)
+/// @return The seconds since then
+static double seconds_since(uint64_t start) {
+    return (double)(trace_now() - start) / 1e9;
+}
 
-    // Top line
-    printf(" A");
-    for (uint8_t i = 0; i < 6; i++)
+/// @brief Writes out every span in a ring and empties it, the caller has to hold `trace_lock`
+/// @param r The pointer to the ring
+static void trace_write_ring(trace_ring_t* r) {
+    for (uint32_t i = 0; i < r->count; i++)
     {
-        printf(" ");
+        trace_span_t* s = &r->spans[i];
+        if(trace_folded) {
+            for (uint8_t j = 0; j < s->depth; j++) fprintf(trace_file, j == 0 ? "%s" : ";%s", s->stack[j]);
+            fprintf(trace_file, " %llu\n", (unsigned long long)(s->self / 1000));
+        } else {
+            fprintf(trace_file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                trace_first ? "" : ",\n", s->stack[s->depth - 1], r->thread,
+                (double)(s->start - trace_epoch) / 1000.0, (double)s->duration / 1000.0);
+            trace_first = 0;
+        }
     }
-    printf("B");
-    for (uint8_t i = 0; i < 6; i++)
-    {
-        printf(" ");
+    r->count = 0;
+}
+
+/// @brief Writes out a ring and hands it back when its thread exits
+/// @param arg The pointer to the ring
+static void trace_release(void* arg) {
+    trace_ring_t* r = (trace_ring_t*)arg;
+    mtx_lock(&trace_lock);
+    if(trace_file != NULL) trace_write_ring(r);
+    r->count = 0;
+    r->open_depth = 0;
+    r->overflow = 0;
+    r->in_use = 0;
+    mtx_unlock(&trace_lock);
+}
+
+/// @brief Writes out everything left and closes the trace file (Called at exit)
+void trace_close() {
+    if(trace_file == NULL) return;
+    mtx_lock(&trace_lock);
+    for (uint32_t i = 0; i < trace_ring_count; i++) trace_write_ring(trace_rings[i]);
+    if(!trace_folded) fprintf(trace_file, "\n]\n");
+    fclose(trace_file);
+    trace_file = NULL;
+    mtx_unlock(&trace_lock);
+
+    if(trace_dropped > 0) {
+        fprintf(stderr, "Trace: spans from %u thread(s) were dropped (More than %d running at once)\n",
+            trace_dropped, TRACE_MAX_THREADS);
     }
-    printf("C");
+}
 
-    printf("\n");
+/// @brief Starts tracing to a file
+/// @param path The file, folded stacks if it ends in ".folded", otherwise Chrome trace JSON
+/// @return Error code (0 = success)
+err_t trace_open(const char* path) {
+    // Only the last `--trace` is kept, finish off any file from before it
+    static uint8_t ready = 0;
+    trace_close();
+
+    trace_file = fopen(path, "w");
+    if(trace_file == NULL) return ERR_IO;
+
+    size_t len = strlen(path);
+    trace_folded = len >= 7 && strcmp(path + len - 7, ".folded") == 0;
+    trace_first = 1;
+    trace_dropped = 0;
+    if(!trace_folded) fprintf(trace_file, "[\n");
+
+    if(!ready) {
+        mtx_init(&trace_lock, mtx_plain);
+        tss_create(&trace_ring_key, trace_release);
+        atexit(trace_close);
+        ready = 1;
+    }
+    trace_epoch = trace_now();
+    return ERR_SUCCESS;
+}
 
-    // Top 3
-    for (uint8_t j = 0; j < 3; j++)
-    {
-        if(j == 0) printf("1");
-        else printf(" ");
+/// @brief Starts a span, has to be matched with `trace_end`
+/// @param name The name of the span (Has to stay around, so a string literal)
+void trace_begin(const char* name) {
+    if(trace_file == NULL) return;
 
-        for (uint8_t i = 0; i < 3; i++)
+    trace_ring_t* r = trace_ring;
+    if(r == NULL) {
+        // First span on this thread, use a ring a thread that has finished gave back, or make a new one
+        mtx_lock(&trace_lock);
+        for (uint32_t i = 0; i < trace_ring_count && r == NULL; i++)
         {
-            for (uint8_t k = 0; k < 6; k++)
-            {
-                switch (b.board[0][i])
-                {
-                case PLR_BLANK:
-                    console_set_color(CONSOLE_BG_WHITE);
-                    break;
-                case PLR_X:
-                    console_set_color(CONSOLE_BG_RED);
-                    break;
-                case PLR_O:
-                    console_set_color(CONSOLE_BG_BLUE);
-                    break;
-                default:
-                    console_set_color(CONSOLE_BG_GREEN);    // Make it obvious that something isn't right
-                    break;
-                }
-                printf(" ");
-                console_reset_color();
-            }
-            printf(" ");
+            if(!trace_rings[i]->in_use) r = trace_rings[i];
         }
-        printf("\n");
+        if(r == NULL && trace_ring_count < TRACE_MAX_THREADS && (r = calloc(1, sizeof(trace_ring_t))) != NULL) {
+            r->thread = trace_ring_count;
+            trace_rings[trace_ring_count++] = r;
+        }
+        if(r == NULL) {
+            trace_dropped++;
+            mtx_unlock(&trace_lock);
+            return;
+        }
+        r->in_use = 1;
+        mtx_unlock(&trace_lock);
+        trace_ring = r;
+        tss_set(trace_ring_key, r);
     }
-    printf("\n");
-    // Middle 3
-    for (uint8_t j = 0; j < 3; j++)
+
+    if(r->open_depth >= TRACE_MAX_DEPTH) {
+        r->overflow++;
+        return;
+    }
+    r->open_names[r->open_depth] = name;
+    r->open_children[r->open_depth] = 0;
+    r->open_start[r->open_depth++] = trace_now();
+}
+
+/// @brief Ends the last span started with `trace_begin`
+void trace_end() {
+    if(trace_file == NULL) return;
+
+    trace_ring_t* r = trace_ring;
+    if(r == NULL) return;
+    if(r->overflow > 0) {
+        r->overflow--;
+        return;
+    }
+    if(r->open_depth == 0) return;
+
+    uint64_t end = trace_now();
+    uint8_t d = --r->open_depth;
+    uint64_t duration = end - r->open_start[d];
+    if(d > 0) r->open_children[d - 1] += duration;
+
+    if(r->count == TRACE_RING_SIZE) {
+        mtx_lock(&trace_lock);
+        trace_write_ring(r);
+        mtx_unlock(&trace_lock);
+    }
+
+    trace_span_t* s = &r->spans[r->count++];
+    memcpy(s->stack, r->open_names, sizeof(const char*) * (d + 1));
+    s->depth = d + 1;
+    s->start = r->open_start[d];
+    s->duration = duration;
+    s->self = duration - r->open_children[d];
+}
+
+static const char* trace_simulate_names[3][3] = {
+    { "simulate A1", "simulate B1", "simulate C1" },
+    { "simulate A2", "simulate B2", "simulate C2" },
+    { "simulate A3", "simulate B3", "simulate C3" }
+};
+
+#pragma region // Rendering
+/*
+    Rendering
+
+    Every board is drawn by `prnt_cells` from a description of it (`render_view_t`),
+    so it works for any size of board, and the look of each place comes from a style
+    table rather than the code:
+    *   large       6x3 places, the original look
+    *   compact     2x1 places
+    Each board has its own default, `--style <name>` changes it for everything.
+
+    If the board is bigger than the terminal, only the part around the focus (The
+    cursor, or the last move) that fits is drawn, so drawing a big board costs the
+    same as drawing a small one. The colour is only changed when it needs to be, and
+    each line is built up and written out in one go.
+*/
+
+#define RENDER_LINE_SIZE    4096    // Bytes built up before being written out
+#define RENDER_RESERVED     6       // Lines left free for the text around the board
+
+typedef struct render_style render_style_t;
+typedef struct render_view render_view_t;
+typedef struct render_line render_line_t;
+
+struct render_style {
+    const char* name;
+    uint8_t width;      // Characters across each place
+    uint8_t height;     // Lines down each place
+    uint8_t gap_x;      // Spaces between places
+    uint8_t gap_y;      // Blank lines between rows
+};
+
+struct render_view {
+    const uint8_t* cells;           // Who is in each place (`plr_t`), row by row from the top
+    uint16_t rows;
+    uint16_t cols;
+    int32_t cursor_row;             // The place to mark (-1 for none)
+    int32_t cursor_col;
+    int32_t focus_row;              // The place to keep in view when it doesn't all fit
+    int32_t focus_col;
+    uint8_t numbered;               // Columns are 1, 2, 3... (Instead of A, B, C...) and rows aren't labelled
+    const render_style_t* style;    // The default style for this board
+};
+
+struct render_line {
+    char text[RENDER_LINE_SIZE];
+    size_t len;
+    int color;                      // The colour set right now (-1 for none)
+};
+
+static const render_style_t render_styles[] = {
+    { "large",   6, 3, 1, 1 },
+    { "compact", 2, 1, 1, 0 }
+};
+static const render_style_t* render_style = NULL;  // Set with `--style`, NULL for each board's default
+
+// Background for each `plr_t`, anything else is green to make it obvious that something isn't right
+static const uint8_t render_colors[3] = { CONSOLE_BG_WHITE, CONSOLE_BG_RED, CONSOLE_BG_BLUE };
+
+/// @brief Finds a style by name
+/// @param name The name (E.g. "compact")
+/// @return The pointer to the style (NULL if there isn't one)
+const render_style_t* render_find_style(const char* name) {
+    for (uint8_t i = 0; i < sizeof(render_styles) / sizeof(render_styles[0]); i++)
     {
-        if(j == 0) printf("2");
-        else printf(" ");
+        if(strcmp(render_styles[i].name, name) == 0) return &render_styles[i];
+    }
+    return NULL;
+}
 
-        for (uint8_t i = 0; i < 3; i++)
-        {
-            for (uint8_t k = 0; k < 6; k++)
-            {
-                switch (b.board[1][i])
-                {
-                case PLR_BLANK:
-                    console_set_color(CONSOLE_BG_WHITE);
-                    break;
-                case PLR_X:
-                    console_set_color(CONSOLE_BG_RED);
-                    break;
-                case PLR_O:
-                    console_set_color(CONSOLE_BG_BLUE);
-                    break;
-                default:
-                    console_set_color(CONSOLE_BG_GREEN);    // Make it obvious that something isn't right
-                    break;
-                }
-                printf(" ");
-                console_reset_color();
-            }
-            printf(" ");
-        }
-        printf("\n");
+/// @brief Gets the size of the terminal
+/// @param lines Set to the number of lines
+/// @param columns Set to the number of columns
+/// @return 1 if it's a terminal, 0 if not (Then there's no limit)
+static uint8_t render_terminal_size(uint16_t* lines, uint16_t* columns) {
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if(!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) return 0;
+    *lines = (uint16_t)(info.srWindow.Bottom - info.srWindow.Top + 1);
+    *columns = (uint16_t)(info.srWindow.Right - info.srWindow.Left + 1);
+#else
+    struct winsize ws;
+    if(!isatty(STDOUT_FILENO) || ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0 || ws.ws_row == 0) return 0;
+    *lines = ws.ws_row;
+    *columns = ws.ws_col;
+#endif
+    return 1;
+}
+
+/// @brief Writes out what's been built up
+static void render_flush(render_line_t* l) {
+    fwrite(l->text, 1, l->len, stdout);
+    l->len = 0;
+}
+
+/// @brief Adds text to the line, writing it out first if it's full
+static void render_put(render_line_t* l, const char* s, size_t n) {
+    if(l->len + n > RENDER_LINE_SIZE) render_flush(l);
+    memcpy(l->text + l->len, s, n);
+    l->len += n;
+}
+
+/// @brief Adds a character to the line, a number of times
+static void render_repeat(render_line_t* l, char c, uint16_t n) {
+    for (uint16_t i = 0; i < n; i++) render_put(l, &c, 1);
+}
+
+/// @brief Changes the colour, if it isn't already that colour (-1 resets it)
+static void render_color(render_line_t* l, int color) {
+    if(color == l->color) return;
+    char code[16];
+    int n = color < 0 ? snprintf(code, sizeof(code), "\x1B[0m") : snprintf(code, sizeof(code), "\x1B[%dm", color);
+    render_put(l, code, (size_t)n);
+    l->color = color;
+}
+
+/// @brief Works out which rows (Or columns) to draw, keeping the focus in the middle if they don't all fit
+/// @param count How many there are
+/// @param fit How many fit
+/// @param focus The one to keep in view
+/// @param first Set to the first one to draw
+/// @return How many to draw
+static uint16_t render_window(uint16_t count, uint16_t fit, int32_t focus, uint16_t* first) {
+    *first = 0;
+    if(fit >= count) return count;
+    if(fit == 0) fit = 1;
+    int32_t start = focus - fit / 2;
+    if(start > count - fit) start = count - fit;
+    if(start < 0) start = 0;
+    *first = (uint16_t)start;
+    return fit;
+}
+
+/// @brief Gets the label of a column (A, B, ... Z, AA, AB... or 1, 2, 3...)
+/// @param col The column
+/// @param numbered Whether to use numbers
+/// @param out Filled with the label (Needs room for 8)
+static void render_col_label(uint16_t col, uint8_t numbered, char* out) {
+    if(numbered) {
+        snprintf(out, 8, "%u", col + 1);
+        return;
     }
-    printf("\n");
-    // Bottom 3
-    for (uint8_t j = 0; j < 3; j++)
+    char rev[8];
+    uint8_t n = 0;
+    uint32_t c = col + 1;
+    while(c > 0 && n < 7) {
+        rev[n++] = (char)('A' + (c - 1) % 26);
+        c = (c - 1) / 26;
+    }
+    for (uint8_t i = 0; i < n; i++) out[i] = rev[n - 1 - i];
+    out[n] = '\0';
+}
+
+/// @brief Draws a board
+/// @param v The pointer to the description of the board
+void prnt_cells(const render_view_t* v) {
+    const render_style_t* s = render_style != NULL ? render_style : v->style;
+    uint16_t step_x = s->width + s->gap_x;
+    uint16_t step_y = s->height + s->gap_y;
+
+    // Row labels go on the left, as wide as the biggest row number
+    char label[8];
+    uint8_t label_width = 0;
+    if(!v->numbered) label_width = (uint8_t)snprintf(label, sizeof(label), "%u", v->rows);
+
+    // Work out how much fits on the screen
+    uint16_t lines, columns, first_row, first_col;
+    uint16_t fit_rows = v->rows, fit_cols = v->cols;
+    if(render_terminal_size(&lines, &columns)) {
+        fit_rows = lines > RENDER_RESERVED + 1 ? (uint16_t)((lines - RENDER_RESERVED - 1 + s->gap_y) / step_y) : 1;
+        fit_cols = columns > label_width ? (uint16_t)((columns - label_width + s->gap_x) / step_x) : 1;
+    }
+    uint16_t show_rows = render_window(v->rows, fit_rows, v->focus_row, &first_row);
+    uint16_t show_cols = render_window(v->cols, fit_cols, v->focus_col, &first_col);
+
+    render_line_t l;
+    l.len = 0;
+    l.color = -1;
+
+    // Column labels
+    render_repeat(&l, ' ', label_width);
+    for (uint16_t c = first_col; c < first_col + show_cols; c++)
     {
-        if(j == 0) printf("3");
-        else printf(" ");
+        render_col_label(c, v->numbered, label);
+        size_t n = strlen(label);
+        if(n > (size_t)(s->width + (c + 1 < first_col + show_cols ? s->gap_x : 0))) n = s->width;
+        uint16_t pad = (uint16_t)((s->width - (n < s->width ? n : s->width)) / 2);
+        render_repeat(&l, ' ', pad);
+        render_put(&l, label, n);
+        if(c + 1 < first_col + show_cols) render_repeat(&l, ' ', (uint16_t)(step_x - pad - n));
+    }
+    render_put(&l, "\n", 1);
 
-        for (uint8_t i = 0; i < 3; i++)
+    for (uint16_t r = first_row; r < first_row + show_rows; r++)
+    {
+        for (uint8_t y = 0; y < s->height; y++)
         {
-            for (uint8_t k = 0; k < 6; k++)
+            // The row number goes on the first line of the row
+            if(y == 0 && label_width > 0) {
+                int n = snprintf(label, sizeof(label), "%-*u", label_width, r + 1);
+                render_put(&l, label, (size_t)n);
+            } else {
+                render_repeat(&l, ' ', label_width);
+            }
+
+            for (uint16_t c = first_col; c < first_col + show_cols; c++)
             {
-                switch (b.board[2][i])
-                {
-                case PLR_BLANK:
-                    console_set_color(CONSOLE_BG_WHITE);
-                    break;
-                case PLR_X:
-                    console_set_color(CONSOLE_BG_RED);
-                    break;
-                case PLR_O:
-                    console_set_color(CONSOLE_BG_BLUE);
-                    break;
-                default:
-                    console_set_color(CONSOLE_BG_GREEN);    // Make it obvious that something isn't right
-                    break;
+                uint8_t cell = v->cells[(size_t)r * v->cols + c];
+                render_color(&l, cell < 3 ? render_colors[cell] : CONSOLE_BG_GREEN);
+
+                // The cursor is a mark in the middle of the place
+                if(r == v->cursor_row && c == v->cursor_col && y == s->height / 2) {
+                    uint8_t mark = s->width >= 4 ? 2 : 1;
+                    uint8_t before = (uint8_t)((s->width - mark) / 2);
+                    render_repeat(&l, ' ', before);
+                    render_put(&l, "\x1B[30m", 5);      // Black, the background stays
+                    render_repeat(&l, '#', mark);
+                    render_put(&l, "\x1B[39m", 5);
+                    render_repeat(&l, ' ', (uint16_t)(s->width - mark - before));
+                } else {
+                    render_repeat(&l, ' ', s->width);
                 }
-                printf(" ");
-                console_reset_color();
+
+                render_color(&l, -1);
+                render_repeat(&l, ' ', s->gap_x);
             }
-            printf(" ");
+            render_put(&l, "\n", 1);
         }
-        printf("\n");
+        if(r + 1 < first_row + show_rows) render_repeat(&l, '\n', s->gap_y);
     }
 
-    // Reset colour
-    console_reset_color();
+    // Say which part is showing if it isn't all of it
+    if(show_rows < v->rows || show_cols < v->cols) {
+        char first[8], last[8];
+        render_col_label(first_col, v->numbered, first);
+        render_col_label(first_col + show_cols - 1, v->numbered, last);
+        char info[96];
+        int n = snprintf(info, sizeof(info), "Showing rows %u-%u of %u, columns %s-%s of %u\n",
+            first_row + 1, first_row + show_rows, v->rows, first, last, v->cols);
+        render_put(&l, info, (size_t)n);
+    }
+
+    render_flush(&l);
 }
 
-/// @brief Select a place
-/// @return The place
-uPoint8 place_select() {
-    printf("Select a place (E.g. \"A1\"): ");
-    char col = ' ';
-    uint8_t row = 0;
-    scanf("%c %d", &col, &row);
-    uint8_t cold = 4;
-    switch (col)
-    {
-    case 'A':
-        cold = 0;
-        break;
-    case 'B':
-        cold = 1;
-        break;
-    case 'C':
-        cold = 2;
-        break;
-    default:
-        break;
-    }
-    return uP8(row - 1, cold);
+#pragma endregion
+
+/// @brief Prints the board to the screen
+/// @param b The board
+void prnt_board(board_t b) {
+    trace_begin("prnt_board");
+
+    render_view_t v;
+    v.cells = &b.board[0][0];
+    v.rows = 3;
+    v.cols = 3;
+    v.cursor_row = cuP8(select_cursor) ? select_cursor.x : -1;
+    v.cursor_col = cuP8(select_cursor) ? select_cursor.y : -1;
+    v.focus_row = v.cursor_row >= 0 ? v.cursor_row : cuP8(last_move) ? last_move.x : 1;
+    v.focus_col = v.cursor_col >= 0 ? v.cursor_col : cuP8(last_move) ? last_move.y : 1;
+    v.numbered = 0;
+    v.style = &render_styles[0];
+    prnt_cells(&v);
+
+    // Reset colour
+    console_reset_color();
+    trace_end();
 }
 
 /// @brief Place the place on the board
@@ -554,6 +1005,57 @@ err_t place_plr(board_t* b, plr_t p, uPoint8 pnt) {
     return ERR_SUCCESS;
 }
 
+/// @brief Reads a board from a compact string, row by row (E.g. "X.O.X...O")
+/// @param s The string, 9 characters of `X`, `O` or `.` (`-` is also accepted as blank)
+/// @param b A pointer to the board object to fill
+/// @return Error code (0 = success)
+err_t parse_board(const char* s, board_t* b) {
+    *b = new_board();
+    for (uint8_t i = 0; i < 9; i++)
+    {
+        switch (s[i])
+        {
+        case 'X':
+        case 'x':
+            b->board[i / 3][i % 3] = PLR_X;
+            break;
+        case 'O':
+        case 'o':
+            b->board[i / 3][i % 3] = PLR_O;
+            break;
+        case '.':
+        case '-':
+            break;
+        default:
+            return ERR_INVALID_PLACE;   // Also catches the string being too short
+        }
+    }
+    if(s[9] != '\0') return ERR_INVALID_PLACE;
+    return ERR_SUCCESS;
+}
+
+/// @brief Prints the error for a board that `parse_board` couldn't read
+/// @param s The string
+void prnt_invalid_board(const char* s) {
+    fprintf(stderr, "Invalid board \"%s\", expected 9 of X, O or . (E.g. \"X.O.X...O\")\n", s);
+}
+
+/// @brief Works out whose turn it is, X always goes first
+/// @param b The pointer to the board
+/// @return The player to move
+plr_t board_to_move(board_t* b) {
+    uint8_t x = 0, o = 0;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        for (uint8_t j = 0; j < 3; j++)
+        {
+            if(b->board[i][j] == PLR_X) x++;
+            if(b->board[i][j] == PLR_O) o++;
+        }
+    }
+    return x > o ? PLR_O : PLR_X;
+}
+
 static uint8_t pos[8][3][2] = {
         { { 0, 0 }, { 1, 0 }, { 2, 0 } }, // Top line       (A)
         { { 0, 1 }, { 1, 1 }, { 2, 1 } }, // Middle line    (A)
@@ -618,280 +1120,2741 @@ void prnt_winner(winner_t winner) {
     printf("!");
 }
 
-void prnt_suggestion(board_t* b) {
-    uPoint8 p = bot_suggest(b);
-    printf("Bot suggestion: %c%d\n", 'A' + p.x, p.y + 1);
+/// @brief Prints the bot's suggestion
+/// @param p The suggestion (See `bot_suggest`)
+void prnt_suggestion(uPoint8 p) {
+    printf("Bot suggestion: %c%d\n", 'A' + p.y, p.x + 1);
 }
 
-/// @brief The main function
-/// @param argc Args count
-/// @param argv Args
-/// @return Return code (0 = Success, anything else = issue/error - e.g. 1)
-int main(int argc, char* argv[]) {
-    game_board = new_board();
-    active_player = PLR_X;
-    while(1) {
-        clr_game_area();
-        prnt_info();
-        prnt_board(game_board);
-        if(active_player == PLR_X) {
-            prnt_suggestion(&game_board);
-            uPoint8 place = place_select();
-            err_t err;
-            if((err = place_plr(&game_board, PLR_X, place)) != ERR_SUCCESS) {
-                active_player = PLR_X; // Maintain active player, invalid move
-            } else {
-                active_player = PLR_O;
-            }
-        } else {
-            // Send board to the bot, and await a response
-            run_bot(&game_board);
-            active_player = PLR_X;
-        }
+#pragma region // Input
+/*
+    Input
 
-        // Check for a winner
-        winner_t winner = check_winner(&game_board);
-        if(winner != NO_WINNER) {
-            clr_game_area();
-            prnt_info();
-            prnt_board(game_board);
+    Moves used to be read with `scanf`, which waits for Enter and leaves the newline behind
+    for the next read (Which is where the double prompts came from). This puts the terminal
+    into raw mode instead, so each key is read as soon as it's pressed:
+    *   Arrow keys move the cursor around the board, Enter or Space places
+    *   Typing a place (E.g. "A1") places straight away, no Enter needed
+    *   Q quits
 
-            prnt_winner(winner);
+    Waiting for a key has a timeout, so `place_select` runs as a loop: it redraws when a key
+    moves the cursor, or when the bot's suggestion (Worked out on another thread) is ready,
+    and never waits on one to get the other.
 
-            break;
-        }
-    }
-}
+    If the input isn't a terminal (E.g. it's piped in), it reads a line at a time instead.
+*/
 
-/*
-    This is the algorithm behind the bot.
+typedef enum input_key input_key_t;
+typedef struct input_event input_event_t;
+typedef struct suggest_job suggest_job_t;
+
+enum input_key {
+    INPUT_KEY_NONE,     // Timed out
+    INPUT_KEY_UP,
+    INPUT_KEY_DOWN,
+    INPUT_KEY_LEFT,
+    INPUT_KEY_RIGHT,
+    INPUT_KEY_ENTER,
+    INPUT_KEY_QUIT,
+    INPUT_KEY_CHAR
+};
 
-    There are 3 main stages when choosing the next move:
-    - See any possible ways that the opposing player could win, and block them.
-      Conflicts within this are dealt with which is the most likely for the player to notice
-    - See any possible ways that the bot could win, easy.
-    - Calculate the likelyness of the next move being a win (Determine which place has the highest likelyhood of a win)
+struct input_event {
+    input_key_t key;
+    char c;             // Only for `INPUT_KEY_CHAR`
+};
 
-    The first 2 checks can be disabled with a flag (check above).
+struct suggest_job {
+    board_t board;
+    uPoint8 result;
+    uint8_t done;
+    mtx_t lock;
+};
 
-    Previous versions of this included a pre-generation algorithm, which takes time and about 20 MB.
-    This one however takes off from the current board, and generates every possible outcome from it.
+static uint8_t input_raw = 0;
+#ifdef _WIN32
+static uint8_t input_checked = 0;
+#else
+static struct termios input_saved;
+#endif
+
+/// @brief Puts the terminal back how it was (Called at exit)
+void input_restore() {
+#ifndef _WIN32
+    if(input_raw) tcsetattr(STDIN_FILENO, TCSANOW, &input_saved);
+#endif
+    input_raw = 0;
+}
 
-    It uses a stepping algorithm to determine the likelyness (as a float) that placing in that specific spot will win.
-    Basically, it goes over every possible available spot, and then places there, it'll then run that same algorithm
-    going back and forth between the player until it either wins, loses, or ties. Losses and ties and grouped together
-    as losses, and are calculated as wins / total to get a decimal.
+/// @brief Puts the terminal back before quitting on an interrupt sent from somewhere else
+/// (Ctrl+C itself comes in as a key in raw mode, and quits like Q does, so the trace gets written)
+/// @param sig The signal
+static void input_interrupt(int sig) {
+    (void)sig;
+    input_restore();
+    _Exit(130);
+}
 
-    The algorithm then goes over every one of the results, and picks the highest. If there is a conflict with more than
-    one having the highest (Two have the same number), it will pick the first option.
-*/
+/// @brief Switches the terminal to raw mode, if it is a terminal
+/// @return 1 if it's in raw mode, 0 if input has to be read a line at a time
+uint8_t input_begin() {
+    if(input_raw) return 1;
+#ifdef _WIN32
+    // There's no mode to change, `_getch` already reads keys straight away
+    if(input_checked) return input_raw;
+    input_checked = 1;
+    if(!_isatty(_fileno(stdin))) return 0;
+    input_raw = 1;
+#else
+    if(!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &input_saved) != 0) return 0;
+
+    struct termios raw = input_saved;
+    raw.c_lflag &= ~(ICANON | ECHO | ISIG);     // Ctrl+C comes through as 3, see `input_from_char`
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    if(tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) return 0;
+
+    input_raw = 1;
+    atexit(input_restore);
+    signal(SIGINT, input_interrupt);
+#endif
+    return 1;
+}
 
-typedef struct bot_board bot_board_t;
+/// @brief Turns a key into an event
+/// @param c The key
+/// @return The event
+static input_event_t input_from_char(int c) {
+    input_event_t e = { INPUT_KEY_CHAR, (char)c };
+    if(c == '\r' || c == '\n' || c == ' ') e.key = INPUT_KEY_ENTER;
+    if(c == 'q' || c == 'Q' || c == 3 || c == EOF) e.key = INPUT_KEY_QUIT;   // 3 is Ctrl+C
+    return e;
+}
 
-struct bot_board {
-    uint64_t wins;
-    uint64_t losses;
-    uint64_t ties;
-};
+/// @brief Waits for a key
+/// @param timeout How long to wait in milliseconds (-1 waits forever)
+/// @return The key pressed (`INPUT_KEY_NONE` if it timed out)
+input_event_t input_poll(int timeout) {
+    input_event_t none = { INPUT_KEY_NONE, 0 };
+#ifdef _WIN32
+    // Sleep until the console has something, rather than checking every so often
+    HANDLE in = GetStdHandle(STD_INPUT_HANDLE);
+    ULONGLONG start = GetTickCount64();
+    while(!_kbhit()) {
+        DWORD wait = INFINITE;
+        if(timeout >= 0) {
+            ULONGLONG waited = GetTickCount64() - start;
+            if(waited >= (ULONGLONG)timeout) return none;
+            wait = (DWORD)(timeout - waited);
+        }
+        if(WaitForSingleObject(in, wait) != WAIT_OBJECT_0) return none;
 
-void bot_simulate_game(board_t* b, bot_board_t* board, plr_t active_player, uPoint8 start);
-uPoint8 bot_check_blocks(board_t* b);
-uPoint8 bot_check_win(board_t* b);
+        // Woken up by something that isn't a key (Key ups, focus, the mouse), throw it away
+        if(!_kbhit()) {
+            INPUT_RECORD record;
+            DWORD read;
+            ReadConsoleInput(in, &record, 1, &read);
+        }
+    }
 
-/// @brief Run the bot algorithm
-/// @param b The pointer to the board
-void run_bot(board_t* b) {
-    // Check for any easy way to win first
-    uPoint8 p = bot_check_win(b);
-    if(cuP8(p)) {
-        place_plr(b, PLR_O, p);
-        return;
+    int c = _getch();
+    if(c == 0 || c == 0xE0) {
+        // Arrow keys come in 2 parts
+        switch (_getch())
+        {
+        case 72: none.key = INPUT_KEY_UP; break;
+        case 80: none.key = INPUT_KEY_DOWN; break;
+        case 75: none.key = INPUT_KEY_LEFT; break;
+        case 77: none.key = INPUT_KEY_RIGHT; break;
+        default: break;
+        }
+        return none;
     }
-    p = bot_check_blocks(b);
-    if(cuP8(p)) {
-        place_plr(b, PLR_O, p);
-        return;
+    return input_from_char(c);
+#else
+    struct pollfd fd = { STDIN_FILENO, POLLIN, 0 };
+    if(poll(&fd, 1, timeout) <= 0) return none;
+
+    unsigned char c;
+    if(read(STDIN_FILENO, &c, 1) != 1) return input_from_char(EOF);
+    if(c != 0x1B) return input_from_char(c);
+
+    // Arrow keys are sent as ESC [ A (B, C, D), anything else after ESC is ignored
+    unsigned char seq[2];
+    if(poll(&fd, 1, 20) <= 0 || read(STDIN_FILENO, &seq[0], 1) != 1 || seq[0] != '[') return none;
+    if(poll(&fd, 1, 20) <= 0 || read(STDIN_FILENO, &seq[1], 1) != 1) return none;
+    switch (seq[1])
+    {
+    case 'A': none.key = INPUT_KEY_UP; break;
+    case 'B': none.key = INPUT_KEY_DOWN; break;
+    case 'C': none.key = INPUT_KEY_RIGHT; break;
+    case 'D': none.key = INPUT_KEY_LEFT; break;
+    default: break;
     }
+    return none;
+#endif
+}
 
-    float probs[3][3] = {
-        { 0.0, 0.0, 0.0 },
-        { 0.0, 0.0, 0.0 },
-        { 0.0, 0.0, 0.0 }
-    };
+/// @brief Thread entry, works out the bot's suggestion
+/// @param arg The pointer to the suggestion job
+/// @return Always 0
+static int suggest_thread(void* arg) {
+    suggest_job_t* job = (suggest_job_t*)arg;
+    uPoint8 p = bot_suggest(&job->board);
+    mtx_lock(&job->lock);
+    job->result = p;
+    job->done = 1;
+    mtx_unlock(&job->lock);
+    return 0;
+}
 
-    bot_board_t boards[3][3];
+/// @brief Checks if the suggestion is ready yet
+/// @param job The pointer to the suggestion job
+/// @return 1 if it's ready
+static uint8_t suggest_ready(suggest_job_t* job) {
+    mtx_lock(&job->lock);
+    uint8_t done = job->done;
+    mtx_unlock(&job->lock);
+    return done;
+}
 
-    // Look at the board first, there's no point in simulating a move that isn't possible
-    for (uint8_t i = 0; i < 3; i++)
+#pragma endregion
+
+/// @brief Turns a typed place (E.g. "A1") into a point
+/// @param col The column letter
+/// @param row The row number
+/// @return The place (Returns an invalid move if it isn't one)
+uPoint8 parse_place(char col, char row) {
+    if(col >= 'a' && col <= 'c') col -= 'a' - 'A';
+    if(col < 'A' || col > 'C' || row < '1' || row > '3') return uP8(5, 5);
+    return uP8(row - '1', col - 'A');
+}
+
+/// @brief Select a place, a line at a time (When the input isn't a terminal)
+/// @param b The pointer to the board
+/// @return The place
+static uPoint8 place_select_line(board_t* b) {
+    clr_game_area();
+    prnt_info();
+    prnt_board(*b);
+    prnt_suggestion(bot_suggest(b));
+    printf("Select a place (E.g. \"A1\"): ");
+
+    char line[32];
+    if(fgets(line, sizeof(line), stdin) == NULL) {
+        // Nothing left to read, so nothing left to play
+        printf("\n");
+        exit(0);
+    }
+
+    // Allow "A1", "A 1" and the like
+    char col = 0, row = 0;
+    for (char* c = line; *c != '\0'; c++)
     {
-        for (uint8_t j = 0; j < 3; j++)
+        if(*c == ' ' || *c == '\t') continue;
+        if(col == 0) col = *c;
+        else if(row == 0) row = *c;
+    }
+    return parse_place(col, row);
+}
+
+/// @brief Draws everything for picking a place
+/// @param b The pointer to the board
+/// @param suggestion The suggestion (An invalid place if it isn't ready yet)
+/// @param typed The column letter typed so far (0 for none)
+static void place_select_draw(board_t* b, uPoint8 suggestion, char typed) {
+    console_reset_cursor();
+    prnt_info();
+    prnt_board(*b);
+    console_clear_line();
+    if(cuP8(suggestion)) prnt_suggestion(suggestion);
+    else printf("Bot suggestion: thinking...\n");
+    console_clear_line();
+    printf("Select a place (Arrow keys and Enter, or type it, E.g. \"A1\"): %c", typed == 0 ? ' ' : typed);
+    fflush(stdout);
+}
+
+/// @brief Select a place
+/// @param b The pointer to the board
+/// @return The place
+uPoint8 place_select(board_t* b) {
+    if(!input_begin()) return place_select_line(b);
+
+    // Work out the suggestion while waiting for keys
+    suggest_job_t job;
+    job.board = *b;
+    job.result = uP8(5, 5);
+    job.done = 0;
+    mtx_init(&job.lock, mtx_plain);
+    thrd_t worker;
+    uint8_t threaded = thrd_create(&worker, suggest_thread, &job) == thrd_success;
+    if(!threaded) suggest_thread(&job);
+
+    static uPoint8 last = { 1, 1 };     // Start where the last place was picked
+    select_cursor = last;
+
+    uPoint8 shown = uP8(5, 5);
+    uPoint8 choice = uP8(5, 5);
+    uint8_t chosen = 0;
+    uint8_t quit = 0;
+    uint8_t redraw = 1;
+    char typed = 0;
+    clr_game_area();
+    while(!chosen) {
+        if(!cuP8(shown) && suggest_ready(&job)) {
+            shown = job.result;
+            redraw = 1;
+        }
+        if(redraw) {
+            place_select_draw(b, shown, typed);
+            redraw = 0;
+        }
+
+        // Only wake up to check on the suggestion until it's shown
+        input_event_t e = input_poll(cuP8(shown) ? -1 : 10);
+        switch (e.key)
         {
-            if(b->board[i][j] == PLR_BLANK) {
-                bot_simulate_game(b, &boards[i][j], PLR_O, uP8(j, i));
+        case INPUT_KEY_UP:    if(select_cursor.x > 0) select_cursor.x--; break;
+        case INPUT_KEY_DOWN:  if(select_cursor.x < 2) select_cursor.x++; break;
+        case INPUT_KEY_LEFT:  if(select_cursor.y > 0) select_cursor.y--; break;
+        case INPUT_KEY_RIGHT: if(select_cursor.y < 2) select_cursor.y++; break;
+        case INPUT_KEY_ENTER:
+            choice = select_cursor;
+            chosen = 1;
+            break;
+        case INPUT_KEY_QUIT:
+            quit = 1;
+            chosen = 1;
+            break;
+        case INPUT_KEY_CHAR:
+            if(typed == 0) {
+                if(cuP8(parse_place(e.c, '1'))) typed = e.c;
+            } else if(cuP8(parse_place(typed, e.c))) {
+                choice = parse_place(typed, e.c);
+                chosen = 1;
+            } else {
+                typed = 0;
             }
+            break;
+        default:
+            break;
         }
+        if(e.key != INPUT_KEY_NONE) redraw = 1;
     }
 
-    for (uint8_t i = 0; i < 3; i++)
-    {
-        for (uint8_t j = 0; j < 3; j++)
-        {
-            probs[i][j] = (float)boards[i][j].wins / ((float)boards[i][j].wins + (float)boards[i][j].losses + (float)boards[i][j].ties);
+    // The suggestion has to finish before exiting, it could still be writing to its trace
+    if(threaded) thrd_join(worker, NULL);
+    mtx_destroy(&job.lock);
+    if(quit) {
+        printf("\n");
+        exit(0);
+    }
+    last = choice;
+    select_cursor = uP8(5, 5);
+    return choice;
+}
+
+
+/// @brief The main function
+/// @param argc Args count
+/// @param argv Args
+/// @return Return code (0 = Success, anything else = issue/error - e.g. 1)
+int main(int argc, char* argv[]) {
+    // These can go in front of anything else
+    while(argc >= 3) {
+        if(strcmp(argv[1], "--trace") == 0) {
+            if(trace_open(argv[2]) != ERR_SUCCESS) {
+                fprintf(stderr, "Could not open trace file \"%s\"\n", argv[2]);
+                return 1;
+            }
+        } else if(strcmp(argv[1], "--style") == 0) {
+            if((render_style = render_find_style(argv[2])) == NULL) {
+                fprintf(stderr, "Unknown style \"%s\" (large or compact)\n", argv[2]);
+                return 1;
+            }
+        } else if(strcmp(argv[1], "--book") == 0) {
+            if(book_open(argv[2]) != ERR_SUCCESS) {
+                fprintf(stderr, "Could not load book from \"%s\"\n", argv[2]);
+                return 1;
+            }
+        } else if(strcmp(argv[1], "--weights") == 0) {
+            if(nt_load(argv[2]) != ERR_SUCCESS) {
+                fprintf(stderr, "Could not load weights from \"%s\"\n", argv[2]);
+                return 1;
+            }
+        } else {
+            break;
         }
+        argc -= 2;
+        argv += 2;
     }
 
-    uPoint8 point = uP8(0, 0);
-    float top = 0.0;
-    for (uint8_t i = 0; i < 3; i++)
-    {
-        for (uint8_t j = 0; j < 3; j++)
-        {
-            if(probs[i][j] > top && b->board[i][j] == PLR_BLANK) {
-                top = probs[i][j];
-                point = uP8(i, j);
+    // Anything passed in runs one of the tools instead of the game
+    if(argc >= 3 && strcmp(argv[1], "--tss") == 0) return tss_main(argv[2]);
+    if(argc >= 2 && strcmp(argv[1], "--perft") == 0) return perft_main(argc - 2, argv + 2);
+    if(argc >= 2 && strcmp(argv[1], "--batch") == 0) return batch_main(argc - 2, argv + 2);
+    if(argc >= 2 && strcmp(argv[1], "--train") == 0) return nt_train_main(argc - 2, argv + 2);
+    if(argc >= 3 && strcmp(argv[1], "--solve") == 0) return pn_main(argv[2]);
+    if(argc >= 2 && strcmp(argv[1], "--gravity") == 0) return gravity_main();
+    if(argc >= 3 && strcmp(argv[1], "--gravity-solve") == 0) return gravity_solve_main(argv[2]);
+    if(argc >= 2 && strcmp(argv[1], "--build-book") == 0) return book_build_main(argc - 2, argv + 2);
+
+    game_board = new_board();
+    active_player = PLR_X;
+    while(1) {
+        if(active_player == PLR_X) {
+            // This draws the board itself, and keeps it up to date while waiting
+            uPoint8 place = place_select(&game_board);
+            err_t err;
+            if((err = place_plr(&game_board, PLR_X, place)) != ERR_SUCCESS) {
+                active_player = PLR_X; // Maintain active player, invalid move
+            } else {
+                last_move = place;
+                active_player = PLR_O;
             }
+        } else {
+            clr_game_area();
+            prnt_info();
+            prnt_board(game_board);
+
+            // Send board to the bot, and await a response
+            last_move = run_bot(&game_board);
+            active_player = PLR_X;
+        }
+
+        // Check for a winner
+        winner_t winner = check_winner(&game_board);
+        if(winner != NO_WINNER) {
+            clr_game_area();
+            prnt_info();
+            prnt_board(game_board);
+
+            prnt_winner(winner);
+
+            break;
         }
     }
+}
 
-    place_plr(b, PLR_O, point);
-    return;
+#define SHARES_MAX_THREADS  64
+
+/// @brief Runs a function on every share of some work, each on its own thread, and waits for them all
+/// (This thread does the first share, and any share whose thread can't be made)
+/// @param func The function, given a pointer to its share
+/// @param shares The shares, one after another
+/// @param size The size of a share
+/// @param count How many shares there are (Up to `SHARES_MAX_THREADS`)
+static void run_shares(thrd_start_t func, void* shares, size_t size, int count) {
+    thrd_t handles[SHARES_MAX_THREADS];
+    uint8_t started[SHARES_MAX_THREADS] = { 0 };
+    for (int i = 1; i < count && i < SHARES_MAX_THREADS; i++)
+    {
+        void* share = (uint8_t*)shares + size * i;
+        started[i] = thrd_create(&handles[i], func, share) == thrd_success;
+        if(!started[i]) func(share);
+    }
+    func(shares);
+    for (int i = 1; i < count && i < SHARES_MAX_THREADS; i++)
+    {
+        if(started[i]) thrd_join(handles[i], NULL);
+    }
 }
 
-/// @brief Simulates the next move by duplicating the board
+/*
+    Perft (Counting every possible game)
+
+    This walks every legal sequence of moves from a board, and counts them up,
+    it doesn't score anything (Unlike `bot_simulate_game`), so it's a quick way to
+    check that `place_plr` and `check_winner` are still right after changing them,
+    and to see how fast the board can be walked.
+
+    From an empty board, to depth 9, it should always come out as:
+    *   255168 games    (Every possible game of noughts and crosses)
+    *   5478 positions  (Every board that can be reached, including the empty one)
+
+    The moves from the starting board are split between threads, each thread has
+    its own copy of the board and counts, and they're added together at the end.
+    Positions are marked in a table indexed by the board in base 3 (3^9 = 19683 boards),
+    so the tables from each thread can just be merged.
+*/
+
+#define PERFT_POSITIONS 19683   // 3^9
+#define PERFT_MAX_THREADS 9     // There's never more than 9 moves to split
+
+typedef struct perft perft_t;
+
+struct perft {
+    board_t board;
+    plr_t to_move;
+    uint8_t depth;
+    uint8_t thread;             // Which thread this is, it walks every `threads`th move from the start
+    uint8_t threads;
+    uint64_t nodes;             // Moves made
+    uint64_t games;             // Sequences that ended with a winner or a tie
+    uint64_t unfinished;        // Sequences that ran out of depth before the game ended
+    uint8_t seen[PERFT_POSITIONS];
+};
+
+static const uint16_t perft_pow3[9] = { 1, 3, 9, 27, 81, 243, 729, 2187, 6561 };
+
+/// @brief Works out the index of a board into the positions table
 /// @param b The pointer to the board
-/// @param board The pointer to the bot board
-/// @param active_player The active player
-/// @param start The starting position
-void bot_simulate_game(board_t* b, bot_board_t* board, plr_t active_player, uPoint8 start) {
-    // Duplicate the board
-    board_t b_cpy;
-    memcpy(&b_cpy, b, sizeof(board_t));
+/// @return The index
+static uint16_t perft_index(board_t* b) {
+    uint16_t index = 0;
+    for (uint8_t i = 0; i < 9; i++) index += b->board[i / 3][i % 3] * perft_pow3[i];
+    return index;
+}
 
-    // Place the active player on the board
-    b_cpy.board[start.y][start.x] = active_player;
-    
-    // Check for any winner
-    winner_t winner = check_winner(&b_cpy);
-    if(winner != NO_WINNER) {
-        if(winner == WINNER_X) board->losses++;
-        if(winner == WINNER_O) board->wins++;
-        else board->ties++;
-        
+/// @brief Walks every move from the board
+/// @param w The pointer to the perft state
+/// @param index The index of the current board (See `perft_index`)
+/// @param p The player to move
+/// @param depth How many more moves to make
+static void perft_walk(perft_t* w, uint16_t index, plr_t p, uint8_t depth) {
+    w->seen[index] = 1;
+    if(check_winner(&w->board) != NO_WINNER) {
+        w->games++;
+        return;
+    }
+    if(depth == 0) {
+        w->unfinished++;
         return;
     }
 
-    // Fork again
-    for (uint8_t i = 0; i < 3; i++)
+    plr_t next = p == PLR_X ? PLR_O : PLR_X;
+    for (uint8_t i = 0; i < 9; i++)
     {
-        for (uint8_t j = 0; j < 3; j++)
+        if(place_plr(&w->board, p, uP8(i / 3, i % 3)) != ERR_SUCCESS) continue;
+        w->nodes++;
+        perft_walk(w, index + p * perft_pow3[i], next, depth - 1);
+        w->board.board[i / 3][i % 3] = PLR_BLANK;
+    }
+}
+
+/// @brief Thread entry, walks this thread's share of the moves from the start
+/// @param arg The pointer to the perft state for this thread
+/// @return Always 0
+static int perft_thread(void* arg) {
+    perft_t* w = (perft_t*)arg;
+    uint16_t index = perft_index(&w->board);
+
+    // The first thread counts the starting board, and the game if it's already over
+    if(check_winner(&w->board) != NO_WINNER || w->depth == 0) {
+        if(w->thread == 0) perft_walk(w, index, w->to_move, 0);
+        return 0;
+    }
+    if(w->thread == 0) w->seen[index] = 1;
+
+    plr_t next = w->to_move == PLR_X ? PLR_O : PLR_X;
+    uint8_t move = 0;
+    for (uint8_t i = 0; i < 9; i++)
+    {
+        if(w->board.board[i / 3][i % 3] != PLR_BLANK) continue;
+        if(move++ % w->threads != w->thread) continue;
+
+        place_plr(&w->board, w->to_move, uP8(i / 3, i % 3));
+        w->nodes++;
+        perft_walk(w, index + w->to_move * perft_pow3[i], next, w->depth - 1);
+        w->board.board[i / 3][i % 3] = PLR_BLANK;
+    }
+    return 0;
+}
+
+/// @brief Counts every game from a board and prints the totals (`--perft <depth> [board] [--threads <n>]`)
+/// @param argc Args count (After `--perft`)
+/// @param argv Args (After `--perft`)
+/// @return Return code (0 = Success, 1 = Invalid arguments)
+int perft_main(int argc, char* argv[]) {
+    if(argc < 1) {
+        fprintf(stderr, "Usage: --perft <depth> [board] [--threads <n>]\n");
+        return 1;
+    }
+
+    int depth = atoi(argv[0]);
+    int threads = 1;
+    board_t b = new_board();
+    for (int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if(parse_board(argv[i], &b) != ERR_SUCCESS) {
+            prnt_invalid_board(argv[i]);
+            return 1;
+        }
+    }
+    if(depth < 0 || depth > 9) depth = 9;
+    if(threads < 1) threads = 1;
+    if(threads > PERFT_MAX_THREADS) threads = PERFT_MAX_THREADS;
+
+    // These are too big for the stack when there's a few of them
+    perft_t* walks = calloc(threads, sizeof(perft_t));
+    if(walks == NULL) return 1;
+    for (int i = 0; i < threads; i++)
+    {
+        walks[i].board = b;
+        walks[i].to_move = board_to_move(&b);
+        walks[i].depth = (uint8_t)depth;
+        walks[i].thread = (uint8_t)i;
+        walks[i].threads = (uint8_t)threads;
+    }
+
+    uint64_t start = trace_now();
+
+    run_shares(perft_thread, walks, sizeof(perft_t), threads);
+
+    double seconds = seconds_since(start);
+
+    // Add it all up
+    uint64_t nodes = 0, games = 0, unfinished = 0, positions = 0;
+    for (int i = 0; i < threads; i++)
+    {
+        nodes += walks[i].nodes;
+        games += walks[i].games;
+        unfinished += walks[i].unfinished;
+    }
+    for (uint16_t j = 0; j < PERFT_POSITIONS; j++)
+    {
+        for (int i = 0; i < threads; i++)
         {
-            if(b_cpy.board[i][j] == PLR_BLANK) {
-                bot_simulate_game(&b_cpy, board, PLR_O, uP8(j, i));
+            if(walks[i].seen[j]) {
+                positions++;
+                break;
             }
         }
     }
+    free(walks);
 
-    return;
+    printf("Depth %d: %llu nodes, %llu games, %llu unfinished, %llu positions\n", depth,
+        (unsigned long long)nodes, (unsigned long long)games, (unsigned long long)unfinished, (unsigned long long)positions);
+    printf("%.3f ms on %d thread(s), %.2f M nodes/sec\n", seconds * 1000.0, threads,
+        seconds > 0.0 ? (double)nodes / seconds / 1e6 : 0.0);
+    return 0;
 }
 
 /*
-    Below are 2 very important checks, these are the checks that can easily
-    block the player, or get an easy win.
+    N-tuple evaluation
 
-    They work in similar ways, by detecting if the player (or bot) are in 2
-    of the 3 positions needed to win. It will then fill the 3rd, blocking or
-    winning easily.
+    A learned way of scoring a board, for when there's too much to simulate every game
+    to the end. Each tuple is a group of places (Here, the 8 lines in `pos`), and every
+    possible way of filling a tuple (3^3 = 27) has a weight. The score of a board is the
+    weights for what's in each tuple, added up, and goes from -1 (O wins) to 1 (X wins).
+
+    The weights are learnt by playing against itself (`--train <games> <file>`), using
+    TD learning: after each move, the score of the board before is moved a little towards
+    the score of the board after (Or who actually won, at the end of the game).
+
+    With weights loaded (`--weights <file>`), the bot only looks `NT_HORIZON` moves ahead
+    of each move it could make, and scores the boards there with this instead of playing
+    every game out.
+
+    With SSE2, the 8 tuple indexes are worked out together (8 x 16 bit lanes), and the
+    8 weights are added up 4 at a time.
+
+    Weight file (Little endian):
+    *   "NACW"
+    *   uint32 version (1), uint32 tuples (8), uint32 entries per tuple (27)
+    *   float weights, tuple by tuple
 */
 
-/// @brief Checks every possible way that the opposing player could win
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NT_SSE2
+#endif
+
+#define NT_TUPLES   8       // One for each line in `pos`
+#define NT_ENTRIES  27      // 3^3
+#define NT_HORIZON  2       // Moves looked at after each move, before scoring
+#define NT_VERSION  1
+
+typedef struct nt_weights nt_weights_t;
+
+struct nt_weights {
+    float w[NT_TUPLES][NT_ENTRIES];
+};
+
+static nt_weights_t* nt_weights = NULL;     // Loaded with `--weights`, NULL to simulate like normal
+
+/// @brief Works out which entry of each tuple the board uses
 /// @param b The pointer to the board
-/// @return A way to block the opposing player (Returns an invalid move if so)
-uPoint8 bot_check_blocks(board_t* b) {
-    for (uint8_t i = 0; i < 8; i++)
+/// @param index Filled with the index for each tuple
+static void nt_indexes(board_t* b, uint16_t index[NT_TUPLES]) {
+    uint16_t c[3][NT_TUPLES];
+    for (uint8_t t = 0; t < NT_TUPLES; t++)
     {
-        uint8_t used = 0;
-        uPoint8 unused;
-        for (uint8_t j = 0; j < 3; j++)
-        {
-            if(b->board[pos[i][j][0]][pos[i][j][1]] == PLR_X) used++;
-            else unused = uP8(pos[i][j][0], pos[i][j][1]);
-        }
-        if(used == 2 && b->board[unused.y][unused.x] == PLR_BLANK) return unused;
+        for (uint8_t j = 0; j < 3; j++) c[j][t] = b->board[pos[t][j][0]][pos[t][j][1]];
     }
-    return uP8(5, 5);
+#ifdef NT_SSE2
+    __m128i c0 = _mm_loadu_si128((const __m128i*)c[0]);
+    __m128i c1 = _mm_loadu_si128((const __m128i*)c[1]);
+    __m128i c2 = _mm_loadu_si128((const __m128i*)c[2]);
+    __m128i i = _mm_add_epi16(c0, _mm_add_epi16(_mm_mullo_epi16(c1, _mm_set1_epi16(3)), _mm_mullo_epi16(c2, _mm_set1_epi16(9))));
+    _mm_storeu_si128((__m128i*)index, i);
+#else
+    for (uint8_t t = 0; t < NT_TUPLES; t++) index[t] = c[0][t] + c[1][t] * 3 + c[2][t] * 9;
+#endif
 }
 
-/// @brief Checks every possible way that the bot could win (easily)
+/// @brief Scores a board
+/// @param w The pointer to the weights
 /// @param b The pointer to the board
-/// @return A way to easily win (Returns an invalid move if so)
-uPoint8 bot_check_win(board_t* b) {
-    for (uint8_t i = 0; i < 8; i++)
+/// @return The score, from -1 (O wins) to 1 (X wins)
+float nt_evaluate(const nt_weights_t* w, board_t* b) {
+    uint16_t index[NT_TUPLES];
+    nt_indexes(b, index);
+#ifdef NT_SSE2
+    __m128 lo = _mm_set_ps(w->w[3][index[3]], w->w[2][index[2]], w->w[1][index[1]], w->w[0][index[0]]);
+    __m128 hi = _mm_set_ps(w->w[7][index[7]], w->w[6][index[6]], w->w[5][index[5]], w->w[4][index[4]]);
+    __m128 sum = _mm_add_ps(lo, hi);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#else
+    float sum = 0.0f;
+    for (uint8_t t = 0; t < NT_TUPLES; t++) sum += w->w[t][index[t]];
+    return sum;
+#endif
+}
+
+/// @brief Moves the score of a board towards a target
+/// @param w The pointer to the weights
+/// @param b The pointer to the board
+/// @param target The score it should have been
+/// @param rate How far to move it (0 to 1)
+static void nt_update(nt_weights_t* w, board_t* b, float target, float rate) {
+    uint16_t index[NT_TUPLES];
+    nt_indexes(b, index);
+    float step = rate * (target - nt_evaluate(w, b)) / NT_TUPLES;
+    for (uint8_t t = 0; t < NT_TUPLES; t++) w->w[t][index[t]] += step;
+}
+
+/// @brief Turns the winner into a score
+/// @param winner The winner
+/// @return 1 for X, -1 for O, 0 for a tie
+static float nt_outcome(winner_t winner) {
+    if(winner == WINNER_X) return 1.0f;
+    if(winner == WINNER_O) return -1.0f;
+    return 0.0f;
+}
+
+/// @brief Looks a few moves ahead, and scores the boards there
+/// @param w The pointer to the weights
+/// @param b The pointer to the board
+/// @param p The player to move
+/// @param depth How many more moves to look at
+/// @return The score, from -1 (O wins) to 1 (X wins), with both players picking their best move
+static float nt_search(const nt_weights_t* w, board_t* b, plr_t p, uint8_t depth) {
+    winner_t winner = check_winner(b);
+    if(winner != NO_WINNER) return nt_outcome(winner);
+    if(depth == 0) return nt_evaluate(w, b);
+
+    plr_t next = p == PLR_X ? PLR_O : PLR_X;
+    float best = p == PLR_X ? -2.0f : 2.0f;
+    for (uint8_t i = 0; i < 9; i++)
     {
-        uint8_t used = 0;
-        uPoint8 unused;
-        for (uint8_t j = 0; j < 3; j++)
-        {
-            if(b->board[pos[i][j][0]][pos[i][j][1]] == PLR_O) used++;
-            else unused = uP8(pos[i][j][0], pos[i][j][1]);
-        }
-        if(used == 2 && b->board[unused.y][unused.x] == PLR_BLANK) return unused;
+        if(place_plr(b, p, uP8(i / 3, i % 3)) != ERR_SUCCESS) continue;
+        float score = nt_search(w, b, next, depth - 1);
+        b->board[i / 3][i % 3] = PLR_BLANK;
+        if(p == PLR_X ? score > best : score < best) best = score;
     }
-    return uP8(5, 5);
+    return best;
 }
 
-/// @brief Uses the same bot algorithms to suggest a move to the player
-/// @param b The pointer ot the board
-/// @return A suggestion as a point
-uPoint8 bot_suggest(board_t* b) {
-    // Check for any easy way to win first
-    uPoint8 p = bot_check_win(b);
-    if(cuP8(p)) {
-        return p;
+/// @brief Scores O making a move, in the same way as the chances from `bot_simulate_game`
+/// @param b The pointer to the board
+/// @param m The move
+/// @return The chance of O winning, from 0 to 1
+float nt_score_move(board_t* b, uPoint8 m) {
+    board_t b_cpy = *b;
+    place_plr(&b_cpy, PLR_O, m);
+    float score = nt_search(nt_weights, &b_cpy, PLR_X, NT_HORIZON);
+
+    // The weights are only trained towards -1 to 1, a board can still add up to more than that
+    float chance = (1.0f - score) / 2.0f;
+    if(chance < 0.0f) return 0.0f;
+    if(chance > 1.0f) return 1.0f;
+    return chance;
+}
+
+/// @brief Loads weights from a file
+/// @param path The file
+/// @return Error code (0 = success)
+err_t nt_load(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if(f == NULL) return ERR_IO;
+
+    char magic[4];
+    uint32_t header[3];
+    nt_weights_t* w = malloc(sizeof(nt_weights_t));
+    uint8_t ok = w != NULL
+        && fread(magic, 1, 4, f) == 4 && memcmp(magic, "NACW", 4) == 0
+        && fread(header, sizeof(uint32_t), 3, f) == 3
+        && header[0] == NT_VERSION && header[1] == NT_TUPLES && header[2] == NT_ENTRIES
+        && fread(w->w, sizeof(float), NT_TUPLES * NT_ENTRIES, f) == NT_TUPLES * NT_ENTRIES;
+    fclose(f);
+
+    if(!ok) {
+        free(w);
+        return ERR_IO;
     }
-    p = bot_check_blocks(b);
-    if(cuP8(p)) {
-        return p;
+    free(nt_weights);
+    nt_weights = w;
+    return ERR_SUCCESS;
+}
+
+/// @brief Saves weights to a file
+/// @param w The pointer to the weights
+/// @param path The file
+/// @return Error code (0 = success)
+err_t nt_save(const nt_weights_t* w, const char* path) {
+    FILE* f = fopen(path, "wb");
+    if(f == NULL) return ERR_IO;
+
+    uint32_t header[3] = { NT_VERSION, NT_TUPLES, NT_ENTRIES };
+    uint8_t ok = fwrite("NACW", 1, 4, f) == 4
+        && fwrite(header, sizeof(uint32_t), 3, f) == 3
+        && fwrite(w->w, sizeof(float), NT_TUPLES * NT_ENTRIES, f) == NT_TUPLES * NT_ENTRIES;
+    if(fclose(f) != 0) ok = 0;
+    return ok ? ERR_SUCCESS : ERR_IO;
+}
+
+/// @brief A small random number generator (xorshift), so training gives the same weights every time
+/// @param state The pointer to the state (Not 0)
+/// @return The next random number
+static uint32_t nt_random(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/// @brief Trains weights by playing against itself, and saves them (`--train <games> <file>`)
+/// @param argc Args count (After `--train`)
+/// @param argv Args (After `--train`)
+/// @return Return code (0 = Success, 1 = Invalid arguments or couldn't save)
+int nt_train_main(int argc, char* argv[]) {
+    if(argc < 2) {
+        fprintf(stderr, "Usage: --train <games> <file>\n");
+        return 1;
     }
+    long games = atol(argv[0]);
+    if(games < 1) games = 1;
 
-    float probs[3][3] = {
-        { 0.0, 0.0, 0.0 },
-        { 0.0, 0.0, 0.0 },
-        { 0.0, 0.0, 0.0 }
-    };
+    nt_weights_t* w = calloc(1, sizeof(nt_weights_t));
+    if(w == NULL) return 1;
 
-    bot_board_t boards[3][3];
+    const float rate = 0.1f;        // How much each move is learnt from
+    const uint32_t explore = 10;    // Percentage of moves that are random, so it sees more boards
+    uint32_t seed = 0x9E3779B9;
+    uint64_t results[4] = { 0 };    // Indexed with `winner_t`
 
-    // Look at the board first, there's no point in simulating a move that isn't possible
-    for (uint8_t i = 0; i < 3; i++)
+    uint64_t start = trace_now();
+
+    for (long g = 0; g < games; g++)
     {
-        for (uint8_t j = 0; j < 3; j++)
-        {
-            if(b->board[i][j] == PLR_BLANK) {
-                bot_simulate_game(b, &boards[i][j], PLR_O, uP8(j, i));
+        board_t b = new_board();
+        plr_t p = PLR_X;
+        winner_t winner = NO_WINNER;
+        while(winner == NO_WINNER) {
+            uPoint8 moves[9];
+            uint8_t count = 0;
+            for (uint8_t i = 0; i < 9; i++)
+            {
+                if(b.board[i / 3][i % 3] == PLR_BLANK) moves[count++] = uP8(i / 3, i % 3);
             }
-        }
-    }
 
-    for (uint8_t i = 0; i < 3; i++)
-    {
-        for (uint8_t j = 0; j < 3; j++)
-        {
-            probs[i][j] = (float)boards[i][j].wins / ((float)boards[i][j].wins + (float)boards[i][j].losses + (float)boards[i][j].ties);
+            // Pick the best move for this player by the current weights, or sometimes a random one
+            uPoint8 move = moves[nt_random(&seed) % count];
+            if(nt_random(&seed) % 100 >= explore) {
+                float best = p == PLR_X ? -2.0f : 2.0f;
+                for (uint8_t i = 0; i < count; i++)
+                {
+                    board_t next = b;
+                    place_plr(&next, p, moves[i]);
+                    winner_t w_next = check_winner(&next);
+                    float score = w_next != NO_WINNER ? nt_outcome(w_next) : nt_evaluate(w, &next);
+                    if(p == PLR_X ? score > best : score < best) {
+                        best = score;
+                        move = moves[i];
+                    }
+                }
+            }
+
+            board_t before = b;
+            place_plr(&b, p, move);
+            winner = check_winner(&b);
+            nt_update(w, &before, winner != NO_WINNER ? nt_outcome(winner) : nt_evaluate(w, &b), rate);
+            p = p == PLR_X ? PLR_O : PLR_X;
         }
+        results[winner]++;
     }
 
-    uPoint8 point = uP8(0, 0);
-    float top = 0.0;
-    for (uint8_t i = 0; i < 3; i++)
-    {
-        for (uint8_t j = 0; j < 3; j++)
-        {
-            if(probs[i][j] > top && b->board[i][j] == PLR_BLANK) {
-                top = probs[i][j];
-                point = uP8(i, j);
-            }
-        }
+    double seconds = seconds_since(start);
+    printf("Trained on %ld games in %.3f ms (X won %llu, O won %llu, %llu ties)\n", games, seconds * 1000.0,
+        (unsigned long long)results[WINNER_X], (unsigned long long)results[WINNER_O], (unsigned long long)results[WINNER_TIE]);
+
+    err_t err = nt_save(w, argv[1]);
+    free(w);
+    if(err != ERR_SUCCESS) {
+        fprintf(stderr, "Could not save weights to \"%s\"\n", argv[1]);
+        return 1;
     }
+    printf("Saved weights to \"%s\"\n", argv[1]);
+    return 0;
+}
 
-    return point;
-}
\ No newline at end of file
+/*
+    Proof number search
+
+    Rather than counting how many games are won from a board, this proves whether
+    a board is won, lost or drawn, and stops looking at a move as soon as it knows
+    the answer for it (One way to win is enough, but every reply has to be checked
+    when the other player is choosing).
+
+    Every board has 2 numbers, how many more boards at least need to be proved to
+    prove it (The proof number), and the same for disproving it. It always expands
+    whichever board is cheapest to settle, which skips most of the tree. This is the
+    depth first version (df-pn), it keeps the numbers in a table of `PN_TABLE_SIZE`
+    entries (Newer boards replace older ones) rather than keeping the whole tree,
+    so the memory it uses is fixed.
+
+    It proves one player winning at a time, so for a board that isn't won it runs
+    again to see if the other player wins, and if that's disproved too it's a draw.
+
+    Near the end of the game (`PN_ENDGAME_PLACES` places left or fewer), `run_bot`
+    tries this before simulating, and plays straight from it if the board is won or
+    drawn. It gives up after `PN_NODE_LIMIT` boards, so it never costs more than that.
+*/
+
+#define PN_INF              0x3FFFFFFFu
+#define PN_TABLE_SIZE       4096    // Entries in the table
+#define PN_NODE_LIMIT       200000  // Boards to look at before giving up
+#define PN_ENDGAME_PLACES   (9 / 2) // Half the board or less left, before that the simulation (Or the weights) picks
+
+typedef enum pn_result pn_result_t;
+typedef struct pn_entry pn_entry_t;
+typedef struct pn_search pn_search_t;
+
+enum pn_result {
+    PN_UNKNOWN, // Ran out of boards to look at
+    PN_WIN,
+    PN_LOSS,
+    PN_DRAW
+};
+
+struct pn_entry {
+    uint32_t key;       // 0 for empty
+    uint32_t pn;        // Proof number
+    uint32_t dn;        // Disproof number
+};
+
+struct pn_search {
+    board_t board;
+    plr_t attacker;     // The player being proved to win
+    uint64_t nodes;
+    pn_entry_t table[PN_TABLE_SIZE];
+};
+
+/// @brief Works out the table key for a board (The board index, and who the attacker is)
+/// @param s The pointer to the search
+/// @param index The index of the board (See `perft_index`)
+/// @return The key
+static uint32_t pn_key(pn_search_t* s, uint16_t index) {
+    return ((uint32_t)index << 1 | (s->attacker == PLR_O)) + 1;
+}
+
+/// @brief Looks up the numbers for a board, a board that isn't in the table starts at 1 and 1
+/// @param s The pointer to the search
+/// @param index The index of the board
+/// @param pn Set to the proof number
+/// @param dn Set to the disproof number
+static void pn_lookup(pn_search_t* s, uint16_t index, uint32_t* pn, uint32_t* dn) {
+    uint32_t key = pn_key(s, index);
+    pn_entry_t* e = &s->table[key % PN_TABLE_SIZE];
+    if(e->key == key) {
+        *pn = e->pn;
+        *dn = e->dn;
+    } else {
+        *pn = 1;
+        *dn = 1;
+    }
+}
+
+/// @brief Stores the numbers for a board, replacing whatever was there
+/// @param s The pointer to the search
+/// @param index The index of the board
+/// @param pn The proof number
+/// @param dn The disproof number
+static void pn_store(pn_search_t* s, uint16_t index, uint32_t pn, uint32_t dn) {
+    uint32_t key = pn_key(s, index);
+    pn_entry_t* e = &s->table[key % PN_TABLE_SIZE];
+    e->key = key;
+    e->pn = pn;
+    e->dn = dn;
+}
+
+/// @brief Adds 2 proof numbers, without going past `PN_INF`
+static uint32_t pn_add(uint32_t a, uint32_t b) {
+    return a + b >= PN_INF ? PN_INF : a + b;
+}
+
+/// @brief Expands a board until its numbers reach the thresholds
+/// @param s The pointer to the search
+/// @param index The index of the board
+/// @param p The player to move
+/// @param thpn The proof number threshold
+/// @param thdn The disproof number threshold
+static void pn_mid(pn_search_t* s, uint16_t index, plr_t p, uint32_t thpn, uint32_t thdn) {
+    s->nodes++;
+    winner_t winner = check_winner(&s->board);
+    if(winner != NO_WINNER) {
+        if(winner == (winner_t)s->attacker) pn_store(s, index, 0, PN_INF);
+        else pn_store(s, index, PN_INF, 0);
+        return;
+    }
+    if(s->nodes >= PN_NODE_LIMIT) return;
+
+    plr_t next = p == PLR_X ? PLR_O : PLR_X;
+    uint8_t attacking = p == s->attacker;   // Attacker picks 1 move (OR), otherwise every move has to work (AND)
+    uint32_t pn, dn;
+    while(1) {
+        // Add up the children, and find the best one to look at next
+        uint32_t sum = 0, best = PN_INF + 1, second = PN_INF + 1, best_other = 0;
+        uint8_t best_move = 9;
+        for (uint8_t i = 0; i < 9; i++)
+        {
+            if(s->board.board[i / 3][i % 3] != PLR_BLANK) continue;
+            uint32_t c_pn, c_dn;
+            pn_lookup(s, index + p * perft_pow3[i], &c_pn, &c_dn);
+            uint32_t pick = attacking ? c_pn : c_dn;
+            sum = pn_add(sum, attacking ? c_dn : c_pn);
+            if(pick < best) {
+                second = best;
+                best = pick;
+                best_other = attacking ? c_dn : c_pn;
+                best_move = i;
+            } else if(pick < second) {
+                second = pick;
+            }
+        }
+        if(attacking) {
+            pn = best;
+            dn = sum;
+        } else {
+            pn = sum;
+            dn = best;
+        }
+        if(pn >= thpn || dn >= thdn || s->nodes >= PN_NODE_LIMIT || best_move == 9) break;
+
+        // Give the best child enough room to overtake the second best
+        uint32_t c_thpn, c_thdn;
+        if(attacking) {
+            c_thpn = thpn < second + 1 ? thpn : second + 1;
+            c_thdn = pn_add(thdn - dn, best_other);
+        } else {
+            c_thdn = thdn < second + 1 ? thdn : second + 1;
+            c_thpn = pn_add(thpn - pn, best_other);
+        }
+
+        s->board.board[best_move / 3][best_move % 3] = p;
+        pn_mid(s, index + p * perft_pow3[best_move], next, c_thpn, c_thdn);
+        s->board.board[best_move / 3][best_move % 3] = PLR_BLANK;
+    }
+    pn_store(s, index, pn, dn);
+}
+
+/// @brief Tries to prove the attacker wins from the current board
+/// @param s The pointer to the search
+/// @param attacker The player to prove wins
+/// @param p The player to move
+/// @return 1 if proved, 0 if disproved, -1 if it ran out of boards
+static int8_t pn_prove(pn_search_t* s, plr_t attacker, plr_t p) {
+    uint16_t index = perft_index(&s->board);
+    uint32_t pn, dn;
+    s->attacker = attacker;
+    pn_mid(s, index, p, PN_INF, PN_INF);
+    pn_lookup(s, index, &pn, &dn);
+    if(pn == 0) return 1;
+    if(dn == 0) return 0;
+    return -1;
+}
+
+/// @brief Proves whether the board is won, lost or drawn for the player to move
+/// @param b The pointer to the board
+/// @param p The player to move
+/// @param move Set to a move that keeps the result (Any move if it's lost, can be NULL)
+/// @param nodes Set to the number of boards looked at (Can be NULL)
+/// @return The result for the player to move
+pn_result_t bot_proof_search(board_t* b, plr_t p, uPoint8* move, uint64_t* nodes) {
+    plr_t o = p == PLR_X ? PLR_O : PLR_X;
+    pn_result_t result = PN_UNKNOWN;
+    if(nodes != NULL) *nodes = 0;
+    if(check_winner(b) != NO_WINNER) return PN_UNKNOWN;
+
+    pn_search_t* s = calloc(1, sizeof(pn_search_t));
+    if(s == NULL) return PN_UNKNOWN;
+    s->board = *b;
+
+    int8_t won = pn_prove(s, p, p);
+    int8_t lost = won == 0 ? pn_prove(s, o, p) : -1;
+    if(won == 1) result = PN_WIN;
+    else if(lost == 1) result = PN_LOSS;
+    else if(lost == 0) result = PN_DRAW;
+
+    // Find a move that keeps it won (Or drawn), the table usually has these already
+    uPoint8 found = uP8(5, 5);
+    for (uint8_t i = 0; i < 9 && result != PN_UNKNOWN; i++)
+    {
+        if(s->board.board[i / 3][i % 3] != PLR_BLANK) continue;
+        if(result == PN_LOSS) {
+            found = uP8(i / 3, i % 3);  // Anything will do if it's lost
+            break;
+        }
+
+        s->board.board[i / 3][i % 3] = p;
+        int8_t keeps = result == PN_WIN ? pn_prove(s, p, o) == 1 : pn_prove(s, o, o) == 0;
+        s->board.board[i / 3][i % 3] = PLR_BLANK;
+        if(keeps) {
+            found = uP8(i / 3, i % 3);
+            break;
+        }
+    }
+    if(!cuP8(found)) result = PN_UNKNOWN;   // Ran out of boards before any move was proved to keep it
+
+    if(move != NULL) *move = found;
+    if(nodes != NULL) *nodes = s->nodes;
+    free(s);
+    return result;
+}
+
+/// @brief Proves the result of a board and prints it (`--solve <board>`)
+/// @param position The board (See `parse_board`)
+/// @return Return code (0 = Success, 1 = Invalid board)
+int pn_main(const char* position) {
+    board_t b;
+    if(parse_board(position, &b) != ERR_SUCCESS) {
+        prnt_invalid_board(position);
+        return 1;
+    }
+
+    plr_t p = board_to_move(&b);
+    prnt_board(b);
+    if(check_winner(&b) != NO_WINNER) {
+        printf("The game is already over\n");
+        return 0;
+    }
+
+    uPoint8 move;
+    uint64_t nodes;
+    static const char* names[4] = { "unknown", "win", "loss", "draw" };
+    pn_result_t result = bot_proof_search(&b, p, &move, &nodes);
+    printf("%c to move: %s", p == PLR_X ? 'X' : 'O', names[result]);
+    if(result != PN_UNKNOWN && cuP8(move)) printf(", playing %c%d", 'A' + move.y, move.x + 1);
+    printf(" (%llu boards)\n", (unsigned long long)nodes);
+    return 0;
+}
+
+/*
+    This is the algorithm behind the bot.
+
+    These are the steps when choosing the next move (`run_bot`), it plays the first one that gives a move:
+    - If an opening book is loaded (`--book`), play the move saved for this board (See "Opening book" below).
+    - See any possible ways that the bot could win, easy.
+    - See any possible ways that the opposing player could win, and block them.
+      Conflicts within this are dealt with which is the most likely for the player to notice
+    - Look for a forcing win, a line of threats the player has to keep blocking (See "Threat space search" below).
+    - Near the end of the game (`PN_ENDGAME_PLACES` places left or fewer), prove if it's won or drawn and play
+      the move that keeps it (See "Proof number search" above).
+    - Otherwise score every place and play the best (`bot_best_move`), either by calculating the likelyness of
+      the next move being a win (Below), or with weights loaded (`--weights`), looking `NT_HORIZON` moves ahead
+      and scoring the boards there (See "N-tuple evaluation" above).
+
+    The middle 4 are `bot_pre_checks`, which the suggestions (`bot_suggest`) use too.
+
+    Previous versions of this included a pre-generation algorithm, which takes time and about 20 MB.
+    This one however takes off from the current board, and generates every possible outcome from it.
+
+    It uses a stepping algorithm to determine the likelyness (as a float) that placing in that specific spot will win.
+    Basically, it goes over every possible available spot, and then places there, it'll then run that same algorithm
+    going back and forth between the player until it either wins, loses, or ties. Losses and ties and grouped together
+    as losses, and are calculated as wins / total to get a decimal.
+
+    The algorithm then goes over every one of the results, and picks the highest. If there is a conflict with more than
+    one having the highest (Two have the same number), it will pick the first option.
+*/
+
+typedef struct bot_board bot_board_t;
+
+struct bot_board {
+    uint64_t wins;
+    uint64_t losses;
+    uint64_t ties;
+};
+
+void bot_simulate_game(board_t* b, bot_board_t* board, plr_t active_player, uPoint8 start);
+uPoint8 bot_check_blocks(board_t* b);
+uPoint8 bot_check_win(board_t* b);
+uPoint8 bot_threat_search(board_t* b, plr_t p, uPoint8* line, uint8_t* len);
+
+uPoint8 bot_pre_checks(board_t* b, plr_t p);
+uPoint8 bot_best_move(board_t* b, float probs[3][3]);
+uPoint8 book_move(board_t* b);
+
+/// @brief Run the bot algorithm
+/// @param b The pointer to the board
+/// @return The place it played
+uPoint8 run_bot(board_t* b) {
+    trace_begin("run_bot");
+
+    // Openings come straight from the book, if there is one
+    trace_begin("book_move");
+    uPoint8 p = book_move(b);
+    trace_end();
+
+    // Check for any easy way to win first
+    if(!cuP8(p)) p = bot_pre_checks(b, PLR_O);
+    if(!cuP8(p)) {
+        float probs[3][3];
+        p = bot_best_move(b, probs);
+    }
+
+    place_plr(b, PLR_O, p);
+    trace_end();
+    return p;
+}
+
+/// @brief Runs the quick checks (Easy wins, blocks, forcing wins, then proving it near the end) before simulating anything
+/// @param b The pointer to the board
+/// @param p The player the forcing wins are looked for
+/// @return The move to make (Returns an invalid move if none of the checks found one)
+uPoint8 bot_pre_checks(board_t* b, plr_t p) {
+    trace_begin("bot_check_win");
+    uPoint8 point = bot_check_win(b);
+    trace_end();
+    if(cuP8(point)) return point;
+
+    trace_begin("bot_check_blocks");
+    point = bot_check_blocks(b);
+    trace_end();
+    if(cuP8(point)) return point;
+
+    trace_begin("bot_threat_search");
+    point = bot_threat_search(b, p, NULL, NULL);
+    trace_end();
+    if(cuP8(point)) return point;
+
+    // Near the end of the game, prove the result instead of simulating it
+    uint8_t blanks = 0;
+    for (uint8_t i = 0; i < 9; i++) blanks += b->board[i / 3][i % 3] == PLR_BLANK;
+    if(blanks > PN_ENDGAME_PLACES) return uP8(5, 5);
+
+    trace_begin("bot_proof_search");
+    pn_result_t result = bot_proof_search(b, p, &point, NULL);
+    trace_end();
+    if(result == PN_WIN || result == PN_DRAW) return point;
+    return uP8(5, 5);
+}
+
+/// @brief Simulates every move, and picks the one with the highest chance of winning
+/// @param b The pointer to the board
+/// @param probs Filled with the chance of winning for each place (0 for places already taken)
+/// @return The best move
+uPoint8 bot_best_move(board_t* b, float probs[3][3]) {
+    bot_board_t boards[3][3];
+    memset(boards, 0, sizeof(boards));
+
+    // Look at the board first, there's no point in simulating a move that isn't possible
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        for (uint8_t j = 0; j < 3; j++)
+        {
+            probs[i][j] = 0.0;
+            if(b->board[i][j] == PLR_BLANK) {
+                trace_begin(trace_simulate_names[i][j]);
+                if(nt_weights != NULL) {
+                    // Only look a few moves ahead, and let the weights score it from there
+                    probs[i][j] = nt_score_move(b, uP8(i, j));
+                } else {
+                    bot_simulate_game(b, &boards[i][j], PLR_O, uP8(j, i));
+                    probs[i][j] = (float)boards[i][j].wins / ((float)boards[i][j].wins + (float)boards[i][j].losses + (float)boards[i][j].ties);
+                }
+                trace_end();
+            }
+        }
+    }
+
+    // Starting below 0, so the first free place is picked even if every chance is 0
+    uPoint8 point = uP8(0, 0);
+    float top = -1.0;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        for (uint8_t j = 0; j < 3; j++)
+        {
+            if(probs[i][j] > top && b->board[i][j] == PLR_BLANK) {
+                top = probs[i][j];
+                point = uP8(i, j);
+            }
+        }
+    }
+
+    return point;
+}
+
+/// @brief Simulates the next move by duplicating the board
+/// @param b The pointer to the board
+/// @param board The pointer to the bot board
+/// @param active_player The active player
+/// @param start The starting position
+void bot_simulate_game(board_t* b, bot_board_t* board, plr_t active_player, uPoint8 start) {
+    // Duplicate the board
+    board_t b_cpy;
+    memcpy(&b_cpy, b, sizeof(board_t));
+
+    // Place the active player on the board
+    b_cpy.board[start.y][start.x] = active_player;
+    
+    // Check for any winner
+    winner_t winner = check_winner(&b_cpy);
+    if(winner != NO_WINNER) {
+        if(winner == WINNER_X) board->losses++;
+        if(winner == WINNER_O) board->wins++;
+        else board->ties++;
+        
+        return;
+    }
+
+    // Fork again
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        for (uint8_t j = 0; j < 3; j++)
+        {
+            if(b_cpy.board[i][j] == PLR_BLANK) {
+                bot_simulate_game(&b_cpy, board, PLR_O, uP8(j, i));
+            }
+        }
+    }
+
+    return;
+}
+
+/*
+    Below are 2 very important checks, these are the checks that can easily
+    block the player, or get an easy win.
+
+    They work in similar ways, by detecting if the player (or bot) are in 2
+    of the 3 positions needed to win. It will then fill the 3rd, blocking or
+    winning easily.
+*/
+
+/// @brief Checks every possible way that the opposing player could win
+/// @param b The pointer to the board
+/// @return A way to block the opposing player (Returns an invalid move if so)
+uPoint8 bot_check_blocks(board_t* b) {
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        uint8_t used = 0;
+        uPoint8 unused;
+        for (uint8_t j = 0; j < 3; j++)
+        {
+            if(b->board[pos[i][j][0]][pos[i][j][1]] == PLR_X) used++;
+            else unused = uP8(pos[i][j][0], pos[i][j][1]);
+        }
+        if(used == 2 && b->board[unused.x][unused.y] == PLR_BLANK) return unused;
+    }
+    return uP8(5, 5);
+}
+
+/// @brief Checks every possible way that the bot could win (easily)
+/// @param b The pointer to the board
+/// @return A way to easily win (Returns an invalid move if so)
+uPoint8 bot_check_win(board_t* b) {
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        uint8_t used = 0;
+        uPoint8 unused;
+        for (uint8_t j = 0; j < 3; j++)
+        {
+            if(b->board[pos[i][j][0]][pos[i][j][1]] == PLR_O) used++;
+            else unused = uP8(pos[i][j][0], pos[i][j][1]);
+        }
+        if(used == 2 && b->board[unused.x][unused.y] == PLR_BLANK) return unused;
+    }
+    return uP8(5, 5);
+}
+
+/*
+    Threat space search
+
+    The checks above only look one move ahead, they spot a line with 2 of the 3
+    places taken and fill in the 3rd. Threat space search carries that idea on,
+    it only ever plays moves that make a threat (A line that is one away from a win)
+    so the other player is forced to block it, then does the same again from there.
+    If it gets to a move that makes 2 threats at once, the other player can only block
+    one of them, and that's a win.
+
+    Because the other player only ever has one move to pick from, this can look much
+    further ahead than the full simulation for the same cost, which is what would make it
+    worth running on bigger boards (E.g. 5 in a row on 15x15), where there are far too
+    many moves to simulate them all.
+
+    This one is only for 3x3. The threats come from the `pos` line table, but the tables
+    of lines through each place, the loops over the places, and `board_t` itself are all
+    3x3 too, so a bigger board needs all of those sized from the board, not just a new table.
+
+    Each line keeps a count of how many X and O are on it, and placing or removing
+    a piece only updates the lines going through that place. The threats a move makes
+    can only be on those same lines, so they're found without looking at the rest of
+    the board.
+*/
+
+#define TSS_LINES       8   // Number of lines in `pos`
+#define TSS_LINE_LENGTH 3   // Places in a row needed to win
+#define TSS_MAX_DEPTH   4   // Max number of threats in a row, 3x3 can't go past this anyway
+
+typedef struct tss_state tss_state_t;
+
+struct tss_state {
+    board_t board;
+    uint8_t count[3][TSS_LINES];            // Pieces on each line, indexed with `plr_t` (PLR_BLANK isn't used)
+    uPoint8 line[TSS_MAX_DEPTH * 2 + 1];    // The forcing line found, the attacker and the forced replies taking turns
+    uint8_t line_len;
+    uint64_t nodes;
+};
+
+static uint8_t tss_cell_lines[3][3][4];     // Which lines go through each place
+static uint8_t tss_cell_line_count[3][3];
+static once_flag tss_once = ONCE_FLAG_INIT;
+
+/// @brief Fills in the table of which lines go through each place
+static void tss_build_lines() {
+    memset(tss_cell_line_count, 0, sizeof(tss_cell_line_count));
+    for (uint8_t i = 0; i < TSS_LINES; i++)
+    {
+        for (uint8_t j = 0; j < TSS_LINE_LENGTH; j++)
+        {
+            uint8_t x = pos[i][j][0], y = pos[i][j][1];
+            tss_cell_lines[x][y][tss_cell_line_count[x][y]++] = i;
+        }
+    }
+}
+
+/// @brief Builds the table of which lines go through each place, only once (Even with the batch and suggestion threads all asking)
+static void tss_init_lines() {
+    call_once(&tss_once, tss_build_lines);
+}
+
+/// @brief Places a piece and updates the counts on the lines going through it
+/// @param t The pointer to the search state
+/// @param p The player
+/// @param m The place
+static void tss_place(tss_state_t* t, plr_t p, uPoint8 m) {
+    t->board.board[m.x][m.y] = p;
+    for (uint8_t i = 0; i < tss_cell_line_count[m.x][m.y]; i++) t->count[p][tss_cell_lines[m.x][m.y][i]]++;
+}
+
+/// @brief Removes a piece placed with `tss_place`
+/// @param t The pointer to the search state
+/// @param p The player
+/// @param m The place
+static void tss_remove(tss_state_t* t, plr_t p, uPoint8 m) {
+    t->board.board[m.x][m.y] = PLR_BLANK;
+    for (uint8_t i = 0; i < tss_cell_line_count[m.x][m.y]; i++) t->count[p][tss_cell_lines[m.x][m.y][i]]--;
+}
+
+/// @brief Finds the blank place on a line
+/// @param t The pointer to the search state
+/// @param l The line
+/// @return The blank place (Returns an invalid move if there isn't one)
+static uPoint8 tss_blank_on(tss_state_t* t, uint8_t l) {
+    for (uint8_t j = 0; j < TSS_LINE_LENGTH; j++)
+    {
+        if(t->board.board[pos[l][j][0]][pos[l][j][1]] == PLR_BLANK) return uP8(pos[l][j][0], pos[l][j][1]);
+    }
+    return uP8(5, 5);
+}
+
+/// @brief Adds a place to a list if it isn't already in it
+/// @return The new length of the list
+static uint8_t tss_add_unique(uPoint8* list, uint8_t n, uPoint8 p) {
+    for (uint8_t i = 0; i < n; i++)
+    {
+        if(list[i].x == p.x && list[i].y == p.y) return n;
+    }
+    list[n] = p;
+    return n + 1;
+}
+
+/// @brief Finds every place where a player would win straight away
+/// @param t The pointer to the search state
+/// @param p The player
+/// @param out Filled with the places (Needs room for 9)
+/// @return The number of places found
+static uint8_t tss_win_places(tss_state_t* t, plr_t p, uPoint8* out) {
+    plr_t o = p == PLR_X ? PLR_O : PLR_X;
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < TSS_LINES; i++)
+    {
+        if(t->count[p][i] == TSS_LINE_LENGTH - 1 && t->count[o][i] == 0) n = tss_add_unique(out, n, tss_blank_on(t, i));
+    }
+    return n;
+}
+
+/// @brief Finds the threats made by the last move, only looking at the lines going through it
+/// @param t The pointer to the search state
+/// @param p The player that made the move
+/// @param m The move
+/// @param out Filled with the places the other player has to block (Needs room for 4)
+/// @return The number of places found
+static uint8_t tss_threats_from(tss_state_t* t, plr_t p, uPoint8 m, uPoint8* out) {
+    plr_t o = p == PLR_X ? PLR_O : PLR_X;
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < tss_cell_line_count[m.x][m.y]; i++)
+    {
+        uint8_t l = tss_cell_lines[m.x][m.y][i];
+        if(t->count[p][l] == TSS_LINE_LENGTH - 1 && t->count[o][l] == 0) n = tss_add_unique(out, n, tss_blank_on(t, l));
+    }
+    return n;
+}
+
+/// @brief Finds every move that would make at least one threat, the ones making the most go first
+/// @param t The pointer to the search state
+/// @param p The player
+/// @param out Filled with the moves (Needs room for 9)
+/// @return The number of moves found
+static uint8_t tss_threat_moves(tss_state_t* t, plr_t p, uPoint8* out) {
+    plr_t o = p == PLR_X ? PLR_O : PLR_X;
+    uint8_t made[3][3] = { 0 };
+    for (uint8_t i = 0; i < TSS_LINES; i++)
+    {
+        if(t->count[p][i] != TSS_LINE_LENGTH - 2 || t->count[o][i] != 0) continue;
+        for (uint8_t j = 0; j < TSS_LINE_LENGTH; j++)
+        {
+            uint8_t x = pos[i][j][0], y = pos[i][j][1];
+            if(t->board.board[x][y] == PLR_BLANK) made[x][y]++;
+        }
+    }
+
+    uint8_t n = 0;
+    for (uint8_t k = 4; k > 0; k--)
+    {
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            for (uint8_t j = 0; j < 3; j++)
+            {
+                if(made[i][j] == k) out[n++] = uP8(i, j);
+            }
+        }
+    }
+    return n;
+}
+
+/// @brief Searches forcing moves for the attacker
+/// @param t The pointer to the search state
+/// @param attacker The player trying to win
+/// @param depth How many more threats can be made
+/// @param ply Where in `t->line` this move goes
+/// @return `true` if there is a forcing win
+static bool tss_search(tss_state_t* t, plr_t attacker, uint8_t depth, uint8_t ply) {
+    plr_t defender = attacker == PLR_X ? PLR_O : PLR_X;
+    uPoint8 places[9];
+    t->nodes++;
+
+    // A threat left over from before is just a win
+    if(tss_win_places(t, attacker, places) > 0) {
+        t->line[ply] = places[0];
+        t->line_len = ply + 1;
+        return true;
+    }
+    if(depth == 0) return false;
+
+    // If the defender has a threat of their own, blocking it is the only move,
+    // and it only keeps the line going if the block is a threat too
+    uPoint8 moves[9];
+    uint8_t move_count;
+    uint8_t defender_threats = tss_win_places(t, defender, places);
+    if(defender_threats > 1) return false;
+    if(defender_threats == 1) {
+        moves[0] = places[0];
+        move_count = 1;
+    } else {
+        move_count = tss_threat_moves(t, attacker, moves);
+    }
+
+    for (uint8_t i = 0; i < move_count; i++)
+    {
+        uPoint8 m = moves[i];
+        uPoint8 gains[4];
+        bool found = false;
+
+        tss_place(t, attacker, m);
+        uint8_t gain_count = tss_threats_from(t, attacker, m, gains);
+        if(gain_count >= 2) {
+            // Two threats at once, only one of them can be blocked
+            t->line[ply] = m;
+            t->line_len = ply + 1;
+            found = true;
+        } else if(gain_count == 1) {
+            // The defender is forced to block, unless blocking wins for them
+            tss_place(t, defender, gains[0]);
+            bool defender_won = false;
+            for (uint8_t j = 0; j < tss_cell_line_count[gains[0].x][gains[0].y]; j++)
+            {
+                if(t->count[defender][tss_cell_lines[gains[0].x][gains[0].y][j]] == TSS_LINE_LENGTH) defender_won = true;
+            }
+            if(defender_won == false && tss_search(t, attacker, depth - 1, ply + 2) == true) {
+                t->line[ply] = m;
+                t->line[ply + 1] = gains[0];
+                found = true;
+            }
+            tss_remove(t, defender, gains[0]);
+        }
+        tss_remove(t, attacker, m);
+
+        if(found == true) return true;
+    }
+
+    return false;
+}
+
+/// @brief Looks for a forcing win, a line of threats the other player has to keep blocking until they can't
+/// @param b The pointer to the board
+/// @param p The player to look for a win for
+/// @param line Filled with the forcing line, the player's moves and the forced blocks taking turns (Needs room for 9, can be NULL)
+/// @param len Set to the length of the forcing line (Can be NULL)
+/// @return The first move of the forcing win (Returns an invalid move if there isn't one)
+uPoint8 bot_threat_search(board_t* b, plr_t p, uPoint8* line, uint8_t* len) {
+    tss_init_lines();
+
+    tss_state_t t;
+    memset(&t, 0, sizeof(tss_state_t));
+    t.board = *b;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        for (uint8_t j = 0; j < 3; j++)
+        {
+            if(b->board[i][j] != PLR_BLANK) {
+                plr_t placed = b->board[i][j];
+                t.board.board[i][j] = PLR_BLANK;
+                tss_place(&t, placed, uP8(i, j));
+            }
+        }
+    }
+
+    if(len != NULL) *len = 0;
+    if(check_winner(b) != NO_WINNER) return uP8(5, 5);
+    if(tss_search(&t, p, TSS_MAX_DEPTH, 0) == false) return uP8(5, 5);
+
+    if(line != NULL) memcpy(line, t.line, sizeof(uPoint8) * t.line_len);
+    if(len != NULL) *len = t.line_len;
+    return t.line[0];
+}
+
+/// @brief Runs the threat space search on its own and prints the forcing line (`--tss <board>`)
+/// @param position The board (See `parse_board`)
+/// @return Return code (0 = Success, 1 = Invalid board)
+int tss_main(const char* position) {
+    board_t b;
+    if(parse_board(position, &b) != ERR_SUCCESS) {
+        prnt_invalid_board(position);
+        return 1;
+    }
+
+    plr_t p = board_to_move(&b);
+    prnt_board(b);
+
+    uPoint8 line[TSS_MAX_DEPTH * 2 + 1];
+    uint8_t len = 0;
+    uPoint8 m = bot_threat_search(&b, p, line, &len);
+    if(cuP8(m)) {
+        printf("Forcing win for %c:", p == PLR_X ? 'X' : 'O');
+        for (uint8_t i = 0; i < len; i++) printf(" %c%d", 'A' + line[i].y, line[i].x + 1);
+        printf("\n");
+    } else {
+        printf("No forcing win for %c\n", p == PLR_X ? 'X' : 'O');
+    }
+    return 0;
+}
+
+/// @brief Uses the same bot algorithms to suggest a move to the player
+/// @param b The pointer ot the board
+/// @return A suggestion as a point
+uPoint8 bot_suggest(board_t* b) {
+    trace_begin("bot_suggest");
+
+    // Check the book, then for any easy way to win
+    uPoint8 p = book_move(b);
+    if(!cuP8(p)) p = bot_pre_checks(b, PLR_X);
+    if(!cuP8(p)) {
+        float probs[3][3];
+        p = bot_best_move(b, probs);
+    }
+
+    trace_end();
+    return p;
+}
+
+/*
+    Batch evaluation
+
+    Reads lots of boards (From a file, or stdin) and prints what the bot thinks of each one,
+    the chance of winning it works out for every place (The same numbers `run_bot` picks from)
+    and the move it would make, for making datasets without playing the game.
+
+    Boards are read in batches of `BATCH_SIZE`, each batch is split between the threads, and
+    then printed in the same order they were read, so memory use doesn't grow with the input.
+
+    Input is either:
+    *   Text,   one board per line (See `parse_board`)
+    *   Binary  (`--binary`), 2 bytes per board, the little endian base 3 index of the board (See `perft_index`)
+
+    Each line of output is:
+    *   <board> <move> <9 chances, row by row>
+    *   The move is "--" if the game is already over, places already taken have a chance of 0.
+    *   "<line> invalid" for anything that isn't a board, so the output still lines up with the input.
+*/
+
+#define BATCH_SIZE          4096
+#define BATCH_MAX_THREADS   64
+#define BATCH_LINE_LENGTH   64
+
+typedef struct batch_job batch_job_t;
+typedef struct batch_share batch_share_t;
+
+struct batch_job {
+    char text[BATCH_LINE_LENGTH];   // What was read, printed back out with the result
+    board_t board;
+    uint8_t valid;
+    uint8_t over;                   // The game has already finished
+    uPoint8 move;
+    float probs[3][3];
+};
+
+struct batch_share {
+    batch_job_t* jobs;
+    uint32_t count;
+};
+
+/// @brief Works out what the bot would do for one board
+/// @param job The pointer to the job
+static void batch_evaluate(batch_job_t* job) {
+    if(!job->valid) return;
+    if(check_winner(&job->board) != NO_WINNER) {
+        job->over = 1;
+        memset(job->probs, 0, sizeof(job->probs));
+        return;
+    }
+
+    // Same as `run_bot` (Or `bot_suggest` when it's X's turn), but every chance is kept
+    uPoint8 best = bot_best_move(&job->board, job->probs);
+    job->move = bot_pre_checks(&job->board, board_to_move(&job->board));
+    if(!cuP8(job->move)) job->move = best;
+}
+
+/// @brief Thread entry, evaluates a share of the batch
+/// @param arg The pointer to the share
+/// @return Always 0
+static int batch_thread(void* arg) {
+    batch_share_t* share = (batch_share_t*)arg;
+    for (uint32_t i = 0; i < share->count; i++) batch_evaluate(&share->jobs[i]);
+    return 0;
+}
+
+/// @brief Reads the next board
+/// @param in The stream to read from
+/// @param binary Whether the input is 2 byte records instead of lines
+/// @param job The pointer to the job to fill
+/// @return 1 if a board (Or an invalid line) was read, 0 at the end of the input
+static uint8_t batch_read(FILE* in, uint8_t binary, batch_job_t* job) {
+    job->valid = 0;
+    job->over = 0;
+
+    if(binary) {
+        uint8_t record[2];
+        if(fread(record, 1, 2, in) != 2) return 0;
+        uint16_t index = (uint16_t)(record[0] | (record[1] << 8));
+        job->board = new_board();
+        for (uint8_t i = 0; i < 9; i++)
+        {
+            job->board.board[i / 3][i % 3] = index % 3;
+            index /= 3;
+            job->text[i] = ".XO"[job->board.board[i / 3][i % 3]];
+        }
+        job->text[9] = '\0';
+        job->valid = index == 0;    // Anything past 3^9 isn't a board
+        return 1;
+    }
+
+    if(fgets(job->text, sizeof(job->text), in) == NULL) return 0;
+    size_t len = strlen(job->text);
+    if(len > 0 && job->text[len - 1] != '\n' && !feof(in)) {
+        // Too long to be a board, skip the rest of it
+        int c;
+        while((c = fgetc(in)) != '\n' && c != EOF);
+    }
+    while(len > 0 && (job->text[len - 1] == '\n' || job->text[len - 1] == '\r')) job->text[--len] = '\0';
+    job->valid = parse_board(job->text, &job->board) == ERR_SUCCESS;
+    return 1;
+}
+
+/// @brief Prints the result of a job
+/// @param out The stream to write to
+/// @param job The pointer to the job
+static void batch_write(FILE* out, batch_job_t* job) {
+    if(!job->valid) {
+        fprintf(out, "%s invalid\n", job->text);
+        return;
+    }
+    if(job->over) fprintf(out, "%s --", job->text);
+    else fprintf(out, "%s %c%d", job->text, 'A' + job->move.y, job->move.x + 1);
+    for (uint8_t i = 0; i < 9; i++) fprintf(out, " %.4f", job->probs[i / 3][i % 3]);
+    fprintf(out, "\n");
+}
+
+/// @brief Evaluates a stream of boards (`--batch [file] [--binary] [--threads <n>]`)
+/// @param argc Args count (After `--batch`)
+/// @param argv Args (After `--batch`)
+/// @return Return code (0 = Success, 1 = Invalid arguments)
+int batch_main(int argc, char* argv[]) {
+    const char* path = NULL;
+    uint8_t binary = 0;
+    int threads = 1;
+    for (int i = 0; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--binary") == 0) binary = 1;
+        else path = argv[i];
+    }
+    if(threads < 1) threads = 1;
+    if(threads > BATCH_MAX_THREADS) threads = BATCH_MAX_THREADS;
+
+    FILE* in = stdin;
+    if(path != NULL && strcmp(path, "-") != 0) {
+        in = fopen(path, binary ? "rb" : "r");
+        if(in == NULL) {
+            fprintf(stderr, "Could not open \"%s\"\n", path);
+            return 1;
+        }
+    }
+#ifdef _WIN32
+    else if(binary) _setmode(_fileno(stdin), _O_BINARY);
+#endif
+
+    batch_job_t* jobs = malloc(sizeof(batch_job_t) * BATCH_SIZE);
+    if(jobs == NULL) return 1;
+
+    uint32_t count;
+    do {
+        count = 0;
+        while(count < BATCH_SIZE && batch_read(in, binary, &jobs[count])) count++;
+
+        // Split the batch into even shares, this thread does the first one
+        batch_share_t shares[BATCH_MAX_THREADS];
+        uint32_t per = (count + threads - 1) / threads;
+        for (int i = 0; i < threads; i++)
+        {
+            uint32_t first = per * i < count ? per * i : count;
+            shares[i].jobs = &jobs[first];
+            shares[i].count = first + per < count ? per : count - first;
+        }
+        run_shares(batch_thread, shares, sizeof(batch_share_t), threads);
+
+        for (uint32_t i = 0; i < count; i++) batch_write(stdout, &jobs[i]);
+    } while(count == BATCH_SIZE);
+
+    free(jobs);
+    if(in != stdin) fclose(in);
+    return 0;
+}
+
+/*
+    Gravity (Connect Four)
+
+    A different game on the same idea, pieces are dropped into one of 7 columns and
+    fall to the bottom, and it's 4 in a row on a 7x6 board to win. `--gravity` plays it
+    (You're X and go first), and `--gravity-solve <moves>` solves a board.
+
+    The board is a bitboard, each column is 7 bits (6 places, and 1 spare on top so
+    lines can't wrap from one column into the next), 49 bits in total:
+    *   `current`   The pieces of the player to move
+    *   `mask`      Every piece
+    Dropping a piece is adding the bottom bit of the column to `mask` (The carry falls
+    into the first empty place), and 4 in a row is found by shifting the pieces by
+    1 (Up), 7 (Across), 6 and 8 (Diagonals) and ANDing them together.
+
+    The solver is alpha-beta (Negamax), with:
+    *   A transposition table, so boards reached by different orders are only solved once
+    *   Middle columns first, and moves that make the most new threats first
+    *   Never looking at moves that let the other player win straight away
+    *   Null window searches, narrowing in on the score
+    *   Solving the board once, then a null window search per column to find one that gets
+        that score (Rather than solving every column on its own)
+
+    Scores are the same as the usual Connect Four solvers: positive is a win for the
+    player to move, and the sooner the win the bigger the score (0 is a draw).
+*/
+
+#define GRAVITY_WIDTH       7
+#define GRAVITY_HEIGHT      6
+#define GRAVITY_H1          (GRAVITY_HEIGHT + 1)
+#define GRAVITY_PLACES      (GRAVITY_WIDTH * GRAVITY_HEIGHT)
+#define GRAVITY_MIN_SCORE   (-(GRAVITY_PLACES / 2) + 3)
+#define GRAVITY_TABLE_SIZE  8388617 // 8M entries (40 MB), prime so every bit of the key picks the entry
+#define GRAVITY_BOT_NODES   4000000 // Boards the bot looks at before it stops trying to solve the game
+#define GRAVITY_BOT_DEPTH   8       // How far ahead the bot looks if it can't solve it
+
+typedef struct gravity_board gravity_board_t;
+typedef struct gravity_solver gravity_solver_t;
+
+struct gravity_board {
+    uint64_t current;   // The pieces of the player to move
+    uint64_t mask;      // Every piece
+    uint8_t moves;
+    uint8_t last;       // The column last dropped into with `gravity_place` (`GRAVITY_WIDTH` for none), for drawing
+};
+
+struct gravity_solver {
+    uint32_t* keys;     // The bottom 32 bits of the key, with the index (Key % size) that's enough to tell every board apart
+    int8_t* values;     // Upper bounds, offset so 0 means empty
+    uint64_t nodes;
+    uint64_t limit;     // 0 for no limit
+    uint8_t aborted;    // Went over the limit, the result can't be used
+};
+
+uint8_t book_gravity_move(gravity_board_t* g);
+
+static const uint8_t gravity_order[GRAVITY_WIDTH] = { 3, 2, 4, 1, 5, 0, 6 };    // Middle columns first
+
+/// @brief Gets a mask with the bottom place of every column
+static uint64_t gravity_bottom_mask() {
+    uint64_t m = 0;
+    for (uint8_t c = 0; c < GRAVITY_WIDTH; c++) m |= 1ull << (c * GRAVITY_H1);
+    return m;
+}
+
+/// @brief Gets a mask with every place on the board (Not the spare bits)
+static uint64_t gravity_board_mask() {
+    return gravity_bottom_mask() * ((1ull << GRAVITY_HEIGHT) - 1);
+}
+
+/// @brief Gets a mask with every place in a column
+/// @param col The column
+static uint64_t gravity_column_mask(uint8_t col) {
+    return ((1ull << GRAVITY_HEIGHT) - 1) << (col * GRAVITY_H1);
+}
+
+/// @brief Counts the bits set
+static uint8_t gravity_popcount(uint64_t m) {
+    uint8_t c = 0;
+    for (; m; c++) m &= m - 1;
+    return c;
+}
+
+/// @brief Generates a new empty board
+/// @return A new empty board
+gravity_board_t gravity_new_board() {
+    gravity_board_t g = { 0, 0, 0, GRAVITY_WIDTH };
+    return g;
+}
+
+/// @brief Finds every empty place that would make 4 in a row for some pieces
+/// @param position The pieces
+/// @param mask Every piece
+/// @return A mask of the places
+static uint64_t gravity_winning_places(uint64_t position, uint64_t mask) {
+    // Up
+    uint64_t r = (position << 1) & (position << 2) & (position << 3);
+
+    // Across, and both diagonals
+    static const uint8_t shifts[3] = { GRAVITY_H1, GRAVITY_H1 - 1, GRAVITY_H1 + 1 };
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        uint8_t s = shifts[i];
+        uint64_t p = (position << s) & (position << 2 * s);
+        r |= p & (position << 3 * s);
+        r |= p & (position >> s);
+        p = (position >> s) & (position >> 2 * s);
+        r |= p & (position << s);
+        r |= p & (position >> 3 * s);
+    }
+    return r & (gravity_board_mask() ^ mask);
+}
+
+/// @brief Gets the places a piece can be dropped into (One per column that isn't full)
+static uint64_t gravity_possible(gravity_board_t* g) {
+    return (g->mask + gravity_bottom_mask()) & gravity_board_mask();
+}
+
+/// @brief Drops a piece for the player to move
+/// @param g The pointer to the board
+/// @param move The place (A single bit from `gravity_possible`)
+static void gravity_play(gravity_board_t* g, uint64_t move) {
+    g->current ^= g->mask;
+    g->mask |= move;
+    g->moves++;
+}
+
+/// @brief Drops a piece into a column for the player to move
+/// @param g The pointer to the board
+/// @param col The column (0 to 6)
+/// @return Error code (0 = success)
+err_t gravity_place(gravity_board_t* g, uint8_t col) {
+    if(col >= GRAVITY_WIDTH) return ERR_INVALID_PLACE;
+    uint64_t move = gravity_possible(g) & gravity_column_mask(col);
+    if(move == 0) return ERR_PLACE_TAKEN;
+    gravity_play(g, move);
+    g->last = col;
+    return ERR_SUCCESS;
+}
+
+/// @brief Checks if dropping into a column wins for the player to move
+/// @param g The pointer to the board
+/// @param col The column
+/// @return 1 if it wins
+static uint8_t gravity_is_winning_move(gravity_board_t* g, uint8_t col) {
+    return (gravity_winning_places(g->current, g->mask) & gravity_possible(g) & gravity_column_mask(col)) != 0;
+}
+
+/// @brief Check for any winners
+/// @param g The pointer to the board
+winner_t gravity_check_winner(gravity_board_t* g) {
+    // Only the player that just moved can have won, they're the pieces that aren't `current`
+    uint64_t last = g->current ^ g->mask;
+    uint64_t r = last & (last >> 1) & (last >> 2) & (last >> 3);
+    static const uint8_t shifts[3] = { GRAVITY_H1, GRAVITY_H1 - 1, GRAVITY_H1 + 1 };
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        uint64_t m = last & (last >> shifts[i]);
+        r |= m & (m >> 2 * shifts[i]);
+    }
+    if(r) return g->moves % 2 == 1 ? WINNER_X : WINNER_O;  // X goes first
+    if(g->moves == GRAVITY_PLACES) return WINNER_TIE;
+    return NO_WINNER;
+}
+
+/// @brief Finds the moves that don't let the other player win straight after
+/// @param g The pointer to the board
+/// @return A mask of the moves (0 if every move loses)
+static uint64_t gravity_non_losing_moves(gravity_board_t* g) {
+    uint64_t possible = gravity_possible(g);
+    uint64_t opponent_win = gravity_winning_places(g->current ^ g->mask, g->mask);
+    uint64_t forced = possible & opponent_win;
+    if(forced) {
+        if(forced & (forced - 1)) return 0;     // 2 places to block, can't block both
+        possible = forced;
+    }
+    return possible & ~(opponent_win >> 1);    // Don't play under where they'd win
+}
+
+/// @brief Looks up the upper bound stored for a board
+/// @return The stored value (0 if there isn't one)
+static int8_t gravity_table_get(gravity_solver_t* s, uint64_t key) {
+    uint32_t index = (uint32_t)(key % GRAVITY_TABLE_SIZE);
+    return s->keys[index] == (uint32_t)key ? s->values[index] : 0;
+}
+
+/// @brief Stores the upper bound for a board, replacing whatever was there
+static void gravity_table_put(gravity_solver_t* s, uint64_t key, int8_t value) {
+    uint32_t index = (uint32_t)(key % GRAVITY_TABLE_SIZE);
+    s->keys[index] = (uint32_t)key;
+    s->values[index] = value;
+}
+
+/// @brief Alpha-beta search to the end of the game
+/// @param s The pointer to the solver
+/// @param g The pointer to the board (Nobody can win straight away)
+/// @param alpha The lower bound
+/// @param beta The upper bound
+/// @return The score (Exact if between alpha and beta, otherwise a bound)
+static int gravity_negamax(gravity_solver_t* s, gravity_board_t* g, int alpha, int beta) {
+    s->nodes++;
+    if(s->limit != 0 && s->nodes > s->limit) {
+        s->aborted = 1;
+        return alpha;
+    }
+
+    uint64_t next = gravity_non_losing_moves(g);
+    if(next == 0) return -(GRAVITY_PLACES - g->moves) / 2;     // Every move loses
+    if(g->moves >= GRAVITY_PLACES - 2) return 0;               // Draw, nobody can win in the last 2 moves
+
+    int min = -(GRAVITY_PLACES - 2 - g->moves) / 2;            // The other player can't win straight away
+    if(alpha < min) {
+        alpha = min;
+        if(alpha >= beta) return alpha;
+    }
+
+    int max = (GRAVITY_PLACES - 1 - g->moves) / 2;             // This player can't win straight away
+    int8_t stored = gravity_table_get(s, g->current + g->mask);
+    if(stored != 0) max = stored + GRAVITY_MIN_SCORE - 1;
+    if(beta > max) {
+        beta = max;
+        if(alpha >= beta) return beta;
+    }
+
+    // Order the moves by how many threats they make, middle columns first for ties
+    uint64_t moves[GRAVITY_WIDTH];
+    uint8_t scores[GRAVITY_WIDTH];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < GRAVITY_WIDTH; i++)
+    {
+        uint64_t move = next & gravity_column_mask(gravity_order[i]);
+        if(move == 0) continue;
+        uint8_t score = gravity_popcount(gravity_winning_places(g->current | move, g->mask));
+        uint8_t j = count++;
+        for (; j > 0 && scores[j - 1] < score; j--)
+        {
+            moves[j] = moves[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        moves[j] = move;
+        scores[j] = score;
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        gravity_board_t g2 = *g;
+        gravity_play(&g2, moves[i]);
+        int score = -gravity_negamax(s, &g2, -beta, -alpha);
+        if(s->aborted) return alpha;
+        if(score >= beta) return score;
+        if(score > alpha) alpha = score;
+    }
+
+    gravity_table_put(s, g->current + g->mask, (int8_t)(alpha - GRAVITY_MIN_SCORE + 1));
+    return alpha;
+}
+
+/// @brief Sets up a solver
+/// @param s The pointer to the solver
+/// @param limit Boards to look at before giving up (0 for no limit)
+/// @return Error code (0 = success)
+err_t gravity_solver_init(gravity_solver_t* s, uint64_t limit) {
+    s->keys = calloc(GRAVITY_TABLE_SIZE, sizeof(uint32_t));
+    s->values = calloc(GRAVITY_TABLE_SIZE, sizeof(int8_t));
+    s->nodes = 0;
+    s->limit = limit;
+    s->aborted = 0;
+    if(s->keys == NULL || s->values == NULL) {
+        free(s->keys);
+        free(s->values);
+        return ERR_IO;
+    }
+    return ERR_SUCCESS;
+}
+
+/// @brief Frees a solver
+void gravity_solver_free(gravity_solver_t* s) {
+    free(s->keys);
+    free(s->values);
+}
+
+/// @brief Solves a board (Nobody has won yet)
+/// @param s The pointer to the solver
+/// @param g The pointer to the board
+/// @return The score (Check `s->aborted` before using it)
+int gravity_solve(gravity_solver_t* s, gravity_board_t* g) {
+    for (uint8_t c = 0; c < GRAVITY_WIDTH; c++)
+    {
+        if(gravity_is_winning_move(g, c)) return (GRAVITY_PLACES + 1 - g->moves) / 2;
+    }
+
+    // Narrow in on the score with null window searches, trying 0 (Draw) first
+    int min = -(GRAVITY_PLACES - g->moves) / 2;
+    int max = (GRAVITY_PLACES + 1 - g->moves) / 2;
+    while(min < max && !s->aborted) {
+        int med = min + (max - min) / 2;
+        if(med <= 0 && min / 2 < med) med = min / 2;
+        else if(med >= 0 && max / 2 > med) med = max / 2;
+        int r = gravity_negamax(s, g, med, med + 1);
+        if(r <= med) max = r;
+        else min = r;
+    }
+    return min;
+}
+
+/// @brief Finds the best column, solving the board once and then finding a column that gets that score
+/// @param s The pointer to the solver
+/// @param g The pointer to the board (Nobody has won yet)
+/// @param score Set to the score of the column
+/// @return The column (Check `s->aborted` before using it)
+uint8_t gravity_best_move(gravity_solver_t* s, gravity_board_t* g, int* score) {
+    // Winning straight away is always best
+    for (uint8_t i = 0; i < GRAVITY_WIDTH; i++)
+    {
+        if(gravity_is_winning_move(g, gravity_order[i])) {
+            *score = (GRAVITY_PLACES + 1 - g->moves) / 2;
+            return gravity_order[i];
+        }
+    }
+
+    *score = gravity_solve(s, g);
+    uint64_t next = gravity_non_losing_moves(g);
+    if(next == 0) next = gravity_possible(g);   // Every column loses straight away, any will do
+
+    // The first column whose reply can't do better than the opposite of the score (A null window
+    // search each, and the table is full of the boards from solving it already)
+    uint8_t fallback = GRAVITY_WIDTH;
+    for (uint8_t i = 0; i < GRAVITY_WIDTH && !s->aborted; i++)
+    {
+        uint8_t c = gravity_order[i];
+        uint64_t move = next & gravity_column_mask(c);
+        if(move == 0) continue;
+        if(fallback == GRAVITY_WIDTH) fallback = c;
+
+        gravity_board_t g2 = *g;
+        gravity_play(&g2, move);
+        if(g2.moves >= GRAVITY_PLACES - 1) return c;   // Nobody can win from here, it's a draw whatever
+        if(gravity_negamax(s, &g2, -*score, -*score + 1) <= -*score) return c;
+    }
+    return fallback;
+}
+
+/// @brief A quick search that stops after a few moves (For when the game can't be solved in time)
+/// @param g The pointer to the board (Nobody can win straight away)
+/// @param depth How many more moves to look at
+/// @param alpha The lower bound
+/// @param beta The upper bound
+/// @return The score (0 if it's still open at the end)
+static int gravity_search_depth(gravity_board_t* g, uint8_t depth, int alpha, int beta) {
+    uint64_t next = gravity_non_losing_moves(g);
+    if(next == 0) return -(GRAVITY_PLACES - g->moves) / 2;
+    if(g->moves >= GRAVITY_PLACES - 2 || depth == 0) return 0;
+
+    for (uint8_t i = 0; i < GRAVITY_WIDTH; i++)
+    {
+        uint64_t move = next & gravity_column_mask(gravity_order[i]);
+        if(move == 0) continue;
+        gravity_board_t g2 = *g;
+        gravity_play(&g2, move);
+        int score = -gravity_search_depth(&g2, depth - 1, -beta, -alpha);
+        if(score >= beta) return score;
+        if(score > alpha) alpha = score;
+    }
+    return alpha;
+}
+
+/// @brief Picks a column for the bot, solving it if it can, otherwise looking a few moves ahead
+/// @param g The pointer to the board (Nobody has won yet)
+/// @return The column
+uint8_t gravity_bot(gravity_board_t* g) {
+    gravity_solver_t s;
+    if(gravity_solver_init(&s, GRAVITY_BOT_NODES) == ERR_SUCCESS) {
+        int score;
+        uint8_t col = gravity_best_move(&s, g, &score);
+        uint8_t aborted = s.aborted;
+        gravity_solver_free(&s);
+        if(!aborted && col < GRAVITY_WIDTH) return col;
+    }
+
+    uint8_t best = GRAVITY_WIDTH;
+    int best_score = -GRAVITY_PLACES;
+    for (uint8_t i = 0; i < GRAVITY_WIDTH; i++)
+    {
+        uint8_t c = gravity_order[i];
+        uint64_t move = gravity_possible(g) & gravity_column_mask(c);
+        if(move == 0) continue;
+        if(gravity_is_winning_move(g, c)) return c;
+
+        gravity_board_t g2 = *g;
+        gravity_play(&g2, move);
+        int value = -gravity_search_depth(&g2, GRAVITY_BOT_DEPTH, -GRAVITY_PLACES, GRAVITY_PLACES);
+        if(value > best_score || best == GRAVITY_WIDTH) {
+            best_score = value;
+            best = c;
+        }
+    }
+    return best;
+}
+
+/// @brief Gets who is in a place
+/// @param g The pointer to the board
+/// @param col The column
+/// @param row The row (0 is the bottom)
+/// @return The player (`PLR_BLANK` if it's empty)
+plr_t gravity_at(gravity_board_t* g, uint8_t col, uint8_t row) {
+    uint64_t bit = 1ull << (col * GRAVITY_H1 + row);
+    if(!(g->mask & bit)) return PLR_BLANK;
+    uint8_t to_move_is_x = g->moves % 2 == 0;
+    uint8_t current = (g->current & bit) != 0;
+    return current == to_move_is_x ? PLR_X : PLR_O;
+}
+
+/// @brief Prints the board to the screen
+/// @param g The pointer to the board
+/// @param cursor The column the cursor is over (Hidden if it's invalid)
+void prnt_gravity_board(gravity_board_t* g, uint8_t cursor) {
+    trace_begin("prnt_gravity_board");
+
+    uint8_t cells[GRAVITY_HEIGHT][GRAVITY_WIDTH];
+    for (uint8_t row = 0; row < GRAVITY_HEIGHT; row++)
+    {
+        for (uint8_t c = 0; c < GRAVITY_WIDTH; c++) cells[row][c] = gravity_at(g, c, GRAVITY_HEIGHT - 1 - row);
+    }
+
+    render_view_t v;
+    v.cells = &cells[0][0];
+    v.rows = GRAVITY_HEIGHT;
+    v.cols = GRAVITY_WIDTH;
+    v.cursor_row = -1;
+    v.cursor_col = -1;
+    if(cursor < GRAVITY_WIDTH) {
+        // Mark where the piece would land
+        uint8_t height = gravity_popcount(g->mask & gravity_column_mask(cursor));
+        if(height < GRAVITY_HEIGHT) {
+            v.cursor_row = GRAVITY_HEIGHT - 1 - height;
+            v.cursor_col = cursor;
+        }
+    }
+    v.focus_row = GRAVITY_HEIGHT / 2;
+    v.focus_col = GRAVITY_WIDTH / 2;
+    if(v.cursor_row >= 0) {
+        v.focus_row = v.cursor_row;
+        v.focus_col = v.cursor_col;
+    } else if(g->last < GRAVITY_WIDTH) {
+        // Keep the last piece dropped in view
+        v.focus_row = GRAVITY_HEIGHT - gravity_popcount(g->mask & gravity_column_mask(g->last));
+        v.focus_col = g->last;
+    }
+    v.numbered = 1;
+    v.style = &render_styles[1];
+    prnt_cells(&v);
+
+    console_reset_color();
+    trace_end();
+}
+
+/// @brief Reads moves (E.g. "4453", columns 1 to 7) onto a board
+/// @param moves The moves
+/// @param g The pointer to the board to fill
+/// @return Error code (0 = success, `ERR_PLACE_TAKEN` if a column is full or the game is already over)
+err_t gravity_parse_moves(const char* moves, gravity_board_t* g) {
+    *g = gravity_new_board();
+    for (const char* c = moves; *c != '\0'; c++)
+    {
+        if(*c < '1' || *c > '0' + GRAVITY_WIDTH) return ERR_INVALID_PLACE;
+        if(gravity_check_winner(g) != NO_WINNER) return ERR_PLACE_TAKEN;
+        err_t err = gravity_place(g, (uint8_t)(*c - '1'));
+        if(err != ERR_SUCCESS) return err;
+    }
+    return ERR_SUCCESS;
+}
+
+/// @brief Solves a board and prints the result (`--gravity-solve <moves>`)
+/// @param moves The moves played so far (E.g. "4453", columns 1 to 7)
+/// @return Return code (0 = Success, 1 = Invalid moves)
+int gravity_solve_main(const char* moves) {
+    gravity_board_t g;
+    if(gravity_parse_moves(moves, &g) != ERR_SUCCESS) {
+        fprintf(stderr, "Invalid moves \"%s\", expected columns 1 to %d (E.g. \"4453\")\n", moves, GRAVITY_WIDTH);
+        return 1;
+    }
+    prnt_gravity_board(&g, GRAVITY_WIDTH);
+    if(gravity_check_winner(&g) != NO_WINNER) {
+        printf("The game is already over\n");
+        return 0;
+    }
+
+    gravity_solver_t s;
+    if(gravity_solver_init(&s, 0) != ERR_SUCCESS) return 1;
+
+    uint64_t start = trace_now();
+    int score;
+    uint8_t col = gravity_best_move(&s, &g, &score);
+    double seconds = seconds_since(start);
+
+    char p = g.moves % 2 == 0 ? 'X' : 'O';
+    if(score > 0) printf("%c to move: win (Score %d), playing %d\n", p, score, col + 1);
+    else if(score < 0) printf("%c to move: loss (Score %d), playing %d\n", p, score, col + 1);
+    else printf("%c to move: draw, playing %d\n", p, col + 1);
+    printf("%llu boards in %.3f ms\n", (unsigned long long)s.nodes, seconds * 1000.0);
+
+    gravity_solver_free(&s);
+    return 0;
+}
+
+/// @brief Select a column
+/// @param g The pointer to the board
+/// @return The column (0 to 6)
+static uint8_t gravity_select(gravity_board_t* g) {
+    if(!input_begin()) {
+        // A line at a time, when the input isn't a terminal
+        clr_game_area();
+        prnt_gravity_board(g, GRAVITY_WIDTH);
+        printf("Select a column (1 to %d): ", GRAVITY_WIDTH);
+        char line[32];
+        if(fgets(line, sizeof(line), stdin) == NULL) {
+            printf("\n");
+            exit(0);
+        }
+        return (uint8_t)(line[0] - '1');
+    }
+
+    static uint8_t cursor = GRAVITY_WIDTH / 2;
+    uint8_t redraw = 1;
+    clr_game_area();
+    while(1) {
+        if(redraw) {
+            console_reset_cursor();
+            prnt_gravity_board(g, cursor);
+            console_clear_line();
+            printf("Select a column (Arrow keys and Enter, or type 1 to %d): ", GRAVITY_WIDTH);
+            fflush(stdout);
+            redraw = 0;
+        }
+
+        input_event_t e = input_poll(-1);
+        switch (e.key)
+        {
+        case INPUT_KEY_LEFT:  if(cursor > 0) cursor--; break;
+        case INPUT_KEY_RIGHT: if(cursor < GRAVITY_WIDTH - 1) cursor++; break;
+        case INPUT_KEY_ENTER: return cursor;
+        case INPUT_KEY_QUIT:
+            printf("\n");
+            exit(0);
+            break;
+        case INPUT_KEY_CHAR:
+            if(e.c >= '1' && e.c <= '0' + GRAVITY_WIDTH) return cursor = (uint8_t)(e.c - '1');
+            break;
+        default:
+            break;
+        }
+        redraw = 1;
+    }
+}
+
+/// @brief Plays the gravity game against the bot (`--gravity`)
+/// @return Return code (0 = Success)
+int gravity_main() {
+    gravity_board_t g = gravity_new_board();
+    plr_t active = PLR_X;
+    while(1) {
+        if(active == PLR_X) {
+            if(gravity_place(&g, gravity_select(&g)) == ERR_SUCCESS) active = PLR_O;
+        } else {
+            clr_game_area();
+            prnt_gravity_board(&g, GRAVITY_WIDTH);
+            printf("Bot thinking...\n");
+            fflush(stdout);
+
+            uint8_t col = book_gravity_move(&g);
+            if(col >= GRAVITY_WIDTH) {
+                trace_begin("gravity_bot");
+                col = gravity_bot(&g);
+                trace_end();
+            }
+            gravity_place(&g, col);
+            active = PLR_X;
+        }
+
+        winner_t winner = gravity_check_winner(&g);
+        if(winner != NO_WINNER) {
+            clr_game_area();
+            prnt_gravity_board(&g, GRAVITY_WIDTH);
+            prnt_winner(winner);
+            printf("\n");
+            return 0;
+        }
+    }
+}
+
+/*
+    Opening book
+
+    The first few moves take the longest to work out (There's the most game left to play),
+    and they're the same in nearly every game, so they can be worked out once and saved.
+    `--build-book <file> [plies] [gravity plies]` plays through the openings of both games
+    and saves the move the bot picks for each board, then `--book <file>` loads them so the
+    bot plays those straight away instead of searching.
+
+    The openings are played out against itself: on the bot's turn (O) only the move it picks
+    is followed, on X's turn every move X could make is followed, so every board the bot can
+    be given in the first few moves ends up in the book. Noughts and crosses saves X's moves
+    too (For the suggestions), and is small enough to do the whole game by default.
+
+    The file is memory mapped instead of being read in, so loading it costs nothing however
+    big it is, and every copy running on the same machine shares the same pages. The records
+    are sorted, so looking a board up is one binary search.
+
+    Book file (Little endian):
+    *   "NACB"
+    *   uint32 version (1), uint32 records, uint32 0 (So the records are 8 byte aligned)
+    *   uint64 records, sorted, the key in the top 56 bits and the move in the bottom 8
+    Keys have the game in their top 4 bits:
+    *   0   Noughts and crosses, the base 3 index of the board (See `perft_index`), the move is row * 3 + column
+    *   1   Gravity, `current + mask` (Different for every board), the move is the column
+*/
+
+#define BOOK_VERSION            1
+#define BOOK_HEADER_SIZE        16
+#define BOOK_GAME_NOUGHTS       0ull
+#define BOOK_GAME_GRAVITY       1ull
+#define BOOK_KEY(game, board)   (((game) << 52) | (board))
+#define BOOK_NOUGHTS_PLIES      9       // The whole game
+#define BOOK_GRAVITY_PLIES      4       // About a second a board, and 7 times as many boards for every 2 plies
+
+typedef struct book book_t;
+typedef struct book_builder book_builder_t;
+
+struct book {
+    const void* view;           // The whole file, mapped (NULL if there's no book)
+    size_t size;
+    const uint64_t* records;
+    uint32_t count;
+};
+
+struct book_builder {
+    uint64_t* records;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t searched[2];       // Boards searched for each game
+};
+
+static book_t book;
+
+/// @brief Unmaps the book
+void book_close() {
+    if(book.view == NULL) return;
+#ifdef _WIN32
+    UnmapViewOfFile(book.view);
+#else
+    munmap((void*)book.view, book.size);
+#endif
+    memset(&book, 0, sizeof(book));
+}
+
+/// @brief Memory maps a book, and uses it for the bot from then on
+/// @param path The file
+/// @return Error code (0 = success)
+err_t book_open(const char* path) {
+    void* view;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE) return ERR_IO;
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart < BOOK_HEADER_SIZE) {
+        CloseHandle(file);
+        return ERR_IO;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if(mapping == NULL) return ERR_IO;
+    view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);   // The view keeps the mapping open
+    if(view == NULL) return ERR_IO;
+    size = (size_t)file_size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return ERR_IO;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < BOOK_HEADER_SIZE) {
+        close(fd);
+        return ERR_IO;
+    }
+    size = (size_t)st.st_size;
+    view = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);              // The mapping keeps the file open
+    if(view == MAP_FAILED) return ERR_IO;
+#endif
+
+    uint32_t header[3];
+    memcpy(header, (const uint8_t*)view + 4, sizeof(header));
+    if(memcmp(view, "NACB", 4) != 0 || header[0] != BOOK_VERSION
+        || (uint64_t)header[1] * sizeof(uint64_t) > size - BOOK_HEADER_SIZE) {
+#ifdef _WIN32
+        UnmapViewOfFile(view);
+#else
+        munmap(view, size);
+#endif
+        return ERR_IO;
+    }
+
+    if(book.view == NULL) atexit(book_close);
+    book_close();
+    book.view = view;
+    book.size = size;
+    book.records = (const uint64_t*)((const uint8_t*)view + BOOK_HEADER_SIZE);
+    book.count = header[1];
+    return ERR_SUCCESS;
+}
+
+/// @brief Looks a board up in the book
+/// @param key The key of the board (See `BOOK_KEY`)
+/// @param move Set to the move, if it's there
+/// @return 1 if the board is in the book
+static uint8_t book_probe(uint64_t key, uint8_t* move) {
+    uint32_t low = 0, high = book.count;
+    while(low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        uint64_t k = book.records[mid] >> 8;
+        if(k < key) low = mid + 1;
+        else if(k > key) high = mid;
+        else {
+            *move = (uint8_t)book.records[mid];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/// @brief Gets the move from the book for a board
+/// @param b The pointer to the board
+/// @return The move (Returns an invalid move if it's not in the book)
+uPoint8 book_move(board_t* b) {
+    uint8_t move;
+    if(book.view == NULL || !book_probe(BOOK_KEY(BOOK_GAME_NOUGHTS, perft_index(b)), &move)) return uP8(5, 5);
+    if(move > 8 || b->board[move / 3][move % 3] != PLR_BLANK) return uP8(5, 5);  // Not from this version, or broken
+    return uP8(move / 3, move % 3);
+}
+
+/// @brief Gets the column from the book for a gravity board
+/// @param g The pointer to the board
+/// @return The column (`GRAVITY_WIDTH` if it's not in the book)
+uint8_t book_gravity_move(gravity_board_t* g) {
+    uint8_t col;
+    if(book.view == NULL || !book_probe(BOOK_KEY(BOOK_GAME_GRAVITY, g->current + g->mask), &col)) return GRAVITY_WIDTH;
+    if(col >= GRAVITY_WIDTH || (gravity_possible(g) & gravity_column_mask(col)) == 0) return GRAVITY_WIDTH;
+    return col;
+}
+
+/// @brief Checks if a board has already been added
+/// @param bb The pointer to the builder
+/// @param key The key of the board
+/// @return 1 if it has
+static uint8_t book_builder_has(book_builder_t* bb, uint64_t key) {
+    // Only ever a few thousand, and the searches take far longer than this
+    for (uint32_t i = 0; i < bb->count; i++)
+    {
+        if(bb->records[i] >> 8 == key) return 1;
+    }
+    return 0;
+}
+
+/// @brief Adds a board and its move
+/// @param bb The pointer to the builder
+/// @param key The key of the board
+/// @param move The move
+/// @return Error code (0 = success)
+static err_t book_builder_add(book_builder_t* bb, uint64_t key, uint8_t move) {
+    if(bb->count == bb->capacity) {
+        uint32_t capacity = bb->capacity == 0 ? 1024 : bb->capacity * 2;
+        uint64_t* records = realloc(bb->records, capacity * sizeof(uint64_t));
+        if(records == NULL) return ERR_IO;
+        bb->records = records;
+        bb->capacity = capacity;
+    }
+    bb->records[bb->count++] = key << 8 | move;
+    return ERR_SUCCESS;
+}
+
+/// @brief Plays out the noughts and crosses openings from a board, adding what the bot would do
+/// @param bb The pointer to the builder
+/// @param b The pointer to the board
+/// @param plies How many more moves to play
+static void book_build_noughts(book_builder_t* bb, board_t* b, uint8_t plies) {
+    if(plies == 0 || check_winner(b) != NO_WINNER) return;
+    uint64_t key = BOOK_KEY(BOOK_GAME_NOUGHTS, perft_index(b));
+    if(book_builder_has(bb, key)) return;   // Got here in a different order, it's already been played out
+
+    // Same as `run_bot` (Or `bot_suggest` when it's X's turn)
+    plr_t p = board_to_move(b);
+    uPoint8 m = bot_pre_checks(b, p);
+    if(!cuP8(m)) {
+        float probs[3][3];
+        m = bot_best_move(b, probs);
+    }
+    if(book_builder_add(bb, key, m.x * 3 + m.y) != ERR_SUCCESS) return;
+    bb->searched[0]++;
+
+    for (uint8_t i = 0; i < 9; i++)
+    {
+        if(p == PLR_O && i != m.x * 3 + m.y) continue;     // The bot only plays its own move
+        if(place_plr(b, p, uP8(i / 3, i % 3)) != ERR_SUCCESS) continue;
+        book_build_noughts(bb, b, plies - 1);
+        b->board[i / 3][i % 3] = PLR_BLANK;
+    }
+}
+
+/// @brief Plays out the gravity openings from a board, adding what the bot would do on its turns
+/// @param bb The pointer to the builder
+/// @param g The pointer to the board
+/// @param plies How many more moves to play
+static void book_build_gravity(book_builder_t* bb, gravity_board_t* g, uint8_t plies) {
+    if(plies == 0 || gravity_check_winner(g) != NO_WINNER) return;
+
+    uint8_t only = GRAVITY_WIDTH;   // Every column on X's turn
+    if(g->moves % 2 == 1) {
+        uint64_t key = BOOK_KEY(BOOK_GAME_GRAVITY, g->current + g->mask);
+        if(book_builder_has(bb, key)) return;
+
+        only = gravity_bot(g);
+        if(book_builder_add(bb, key, only) != ERR_SUCCESS) return;
+        bb->searched[1]++;
+        printf("\rSearched %u gravity boards", bb->searched[1]);
+        fflush(stdout);
+    }
+
+    for (uint8_t c = 0; c < GRAVITY_WIDTH; c++)
+    {
+        if(only < GRAVITY_WIDTH && c != only) continue;
+        gravity_board_t g2 = *g;
+        if(gravity_place(&g2, c) != ERR_SUCCESS) continue;
+        book_build_gravity(bb, &g2, plies - 1);
+    }
+}
+
+/// @brief Orders records for `qsort`
+static int book_compare(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/// @brief Builds a book and saves it (`--build-book <file> [plies] [gravity plies]`)
+/// @param argc Args count (After `--build-book`)
+/// @param argv Args (After `--build-book`)
+/// @return Return code (0 = Success, 1 = Invalid arguments or couldn't save)
+int book_build_main(int argc, char* argv[]) {
+    if(argc < 1) {
+        fprintf(stderr, "Usage: --build-book <file> [plies] [gravity plies]\n");
+        return 1;
+    }
+    int plies = argc >= 2 ? atoi(argv[1]) : BOOK_NOUGHTS_PLIES;
+    int gravity_plies = argc >= 3 ? atoi(argv[2]) : BOOK_GRAVITY_PLIES;
+    if(plies < 0 || plies > 9) plies = BOOK_NOUGHTS_PLIES;
+    if(gravity_plies < 0 || gravity_plies > GRAVITY_PLACES) gravity_plies = BOOK_GRAVITY_PLIES;
+
+    uint64_t start = trace_now();
+
+    book_builder_t bb;
+    memset(&bb, 0, sizeof(bb));
+    board_t b = new_board();
+    book_build_noughts(&bb, &b, (uint8_t)plies);
+    gravity_board_t g = gravity_new_board();
+    book_build_gravity(&bb, &g, (uint8_t)gravity_plies);
+    if(bb.searched[1] > 0) printf("\n");
+
+    qsort(bb.records, bb.count, sizeof(uint64_t), book_compare);
+    double seconds = seconds_since(start);
+
+    FILE* f = fopen(argv[0], "wb");
+    if(f == NULL) {
+        fprintf(stderr, "Could not open \"%s\"\n", argv[0]);
+        free(bb.records);
+        return 1;
+    }
+    uint32_t header[3] = { BOOK_VERSION, bb.count, 0 };
+    uint8_t ok = fwrite("NACB", 1, 4, f) == 4
+        && fwrite(header, sizeof(uint32_t), 3, f) == 3
+        && fwrite(bb.records, sizeof(uint64_t), bb.count, f) == bb.count;
+    if(fclose(f) != 0) ok = 0;
+    free(bb.records);
+    if(!ok) {
+        fprintf(stderr, "Could not write \"%s\"\n", argv[0]);
+        return 1;
+    }
+
+    printf("%u boards (%u noughts and crosses, %u gravity) in %.3f s, saved to \"%s\"\n",
+        bb.count, bb.searched[0], bb.searched[1], seconds, argv[0]);
+    return 0;
+}